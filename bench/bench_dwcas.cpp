@@ -0,0 +1,81 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "scqueue/detail/detail.hpp"
+
+using atomic_pair_t = scq::detail::atomic_pair_t<int>;
+using pair_t        = scq::detail::pair_t<int>;
+
+template <typename F>
+void bench(std::string_view name, std::size_t thread_count, std::size_t ops, F&& op);
+
+int main(int argc, const char* argv[]) {
+  const std::size_t thread_count = argc > 1 ? std::stoul(argv[1]) : 1;
+  const std::size_t ops = argc > 2 ? std::stoul(argv[2]) : 1'000'000;
+
+  std::cout << "avx loads: " << scq::detail::cpu_features.avx_loads
+            << ", cmpxchg16b: " << scq::detail::cpu_features.cx16 << std::endl;
+
+  atomic_pair_t pair{ };
+  int elem = 0;
+
+  bench("load", thread_count, ops, [&](std::size_t) {
+    const auto res = pair.load(std::memory_order_acquire);
+    asm volatile("" :: "r"(res.tag), "r"(res.ptr));
+  });
+
+  bench("compare_exchange_weak", thread_count, ops, [&](std::size_t i) {
+    auto expected = pair.load(std::memory_order_relaxed);
+    (void) pair.compare_exchange_weak(
+        expected,
+        pair_t{ i, &elem },
+        std::memory_order_acq_rel,
+        std::memory_order_acquire
+    );
+  });
+
+  bench("fetch_or", thread_count, ops, [&](std::size_t i) {
+    (void) pair.fetch_or(pair_t{ i & 0b11, nullptr }, std::memory_order_acq_rel);
+  });
+
+  bench("fetch_and", thread_count, ops, [&](std::size_t i) {
+    (void) pair.fetch_and(pair_t{ ~(i & 0b11), &elem }, std::memory_order_acq_rel);
+  });
+
+  return 0;
+}
+
+template <typename F>
+void bench(std::string_view name, std::size_t thread_count, std::size_t ops, F&& op) {
+  std::vector<std::thread> threads{ };
+  threads.reserve(thread_count);
+
+  std::atomic_bool start{ false };
+  for (auto thread = 0; thread < thread_count; ++thread) {
+    threads.emplace_back([&] {
+      while (!start.load());
+
+      for (std::size_t i = 0; i < ops; ++i) {
+        op(i);
+      }
+    });
+  }
+
+  const auto begin = std::chrono::steady_clock::now();
+  start.store(true);
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+  const auto ns = std::chrono::duration<double, std::nano>(end - begin).count();
+  std::cout << name << ": " << ns / static_cast<double>(ops * thread_count)
+            << " ns/op (" << thread_count << " threads)" << std::endl;
+}
@@ -0,0 +1,86 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "scqueue/scq2.hpp"
+#include "scqueue/scqd.hpp"
+
+template <typename Q>
+void bench(std::string_view name, std::size_t thread_count, std::size_t ops);
+
+int main(int argc, const char* argv[]) {
+  const std::size_t ops = argc > 1 ? std::stoul(argv[1]) : 1 << 16;
+
+  for (const std::size_t thread_count : { 16, 32, 64 }) {
+    bench<scq::cas2::bounded_queue_t<int, 12>>("scq2 (single)", thread_count, ops);
+    bench<scq::cas2::bounded_queue_t<int, 12, false, 16>>("scq2 (striped)", thread_count, ops);
+    bench<scq::d::bounded_queue_t<int, 12>>("scqd (single)", thread_count, ops);
+    bench<scq::d::bounded_queue_t<int, 12, false, std::uintmax_t, 16>>(
+        "scqd (striped)", thread_count, ops
+    );
+  }
+
+  return 0;
+}
+
+/**
+ * Runs half the threads as producers and half as consumers, which keeps the
+ * queue close to empty, so that failed dequeues hit the threshold frequently.
+ */
+template <typename Q>
+void bench(std::string_view name, std::size_t thread_count, std::size_t ops) {
+  auto queue = std::make_unique<Q>();
+  int elem = 0;
+
+  std::vector<std::thread> threads{ };
+  threads.reserve(thread_count);
+
+  std::atomic_bool start{ false };
+  std::atomic_size_t failed{ 0 };
+
+  for (auto thread = 0; thread < thread_count / 2; ++thread) {
+    // producer thread
+    threads.emplace_back([&] {
+      while (!start.load());
+
+      for (std::size_t op = 0; op < ops; ++op) {
+        while (!queue->try_enqueue(&elem));
+      }
+    });
+
+    // consumer thread
+    threads.emplace_back([&] {
+      std::size_t thread_failed = 0;
+      while (!start.load());
+
+      for (std::size_t op = 0; op < ops; ++op) {
+        int* deq;
+        while (!queue->try_dequeue(deq)) {
+          thread_failed += 1;
+        }
+      }
+
+      failed.fetch_add(thread_failed);
+    });
+  }
+
+  const auto begin = std::chrono::steady_clock::now();
+  start.store(true);
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+  const auto secs = std::chrono::duration<double>(end - begin).count();
+  const auto total = static_cast<double>(ops * (thread_count / 2));
+  std::cout << name << ", " << thread_count << " threads: "
+            << total / secs / 1e6 << " Mops/s, "
+            << failed.load() << " failed dequeues" << std::endl;
+}
@@ -0,0 +1,183 @@
+#ifndef SCQ_DELAY_QUEUE_HPP
+#define SCQ_DELAY_QUEUE_HPP
+
+#include <stdexcept>
+#include <thread>
+
+#include "scqueue/delay_queue_fwd.hpp"
+#include "scqueue/detail/ready_queue.hpp"
+#include "scqueue/scq2.hpp"
+
+namespace scq::timer {
+template <typename T, std::size_t O, std::size_t W, std::size_t L>
+  requires timer_c<T>
+delay_queue_t<T, O, W, L>::delay_queue_t(std::uintmax_t start) noexcept :
+    m_tick{ start } {}
+
+template <typename T, std::size_t O, std::size_t W, std::size_t L>
+  requires timer_c<T>
+bool delay_queue_t<T, O, W, L>::schedule(pointer elem) {
+  if (elem == nullptr) [[unlikely]] {
+    throw std::invalid_argument("`elem` must not be null");
+  }
+
+  return this->insert(elem, this->m_tick.load(acquire));
+}
+
+template <typename T, std::size_t O, std::size_t W, std::size_t L>
+  requires timer_c<T>
+template <typename F>
+std::size_t delay_queue_t<T, O, W, L>::advance(std::uintmax_t now, F&& callback) {
+  std::size_t fired = 0;
+
+  auto tick = this->m_tick.load(acquire);
+  while (tick <= now) {
+    // claim the tick, any thread failing to do so retries with the next one
+    if (!this->m_tick.compare_exchange_weak(tick, tick + 1, seq_cst, acquire)) {
+      continue;
+    }
+
+    std::atomic_thread_fence(seq_cst);
+    fired += this->process_tick(tick, callback);
+    tick += 1;
+  }
+
+  // drain buckets which have received timers after being processed, bounded,
+  // since buckets keeping timers that could not be re-queued are marked again
+  std::size_t id;
+  for (auto n = LATE_CAPACITY; n > 0 && this->m_late.try_dequeue(id); --n) {
+    this->m_late.unschedule(id, seq_cst);
+    fired += this->process_bucket(id / BUCKETS, id % BUCKETS, callback);
+  }
+
+  return fired;
+}
+
+template <typename T, std::size_t O, std::size_t W, std::size_t L>
+  requires timer_c<T>
+std::uintmax_t delay_queue_t<T, O, W, L>::next_tick() const noexcept {
+  return this->m_tick.load(acquire);
+}
+
+template <typename T, std::size_t O, std::size_t W, std::size_t L>
+  requires timer_c<T>
+auto delay_queue_t<T, O, W, L>::place(
+    std::uintmax_t deadline,
+    std::uintmax_t now
+) noexcept -> placement_t {
+  if (deadline < now) {
+    deadline = now;
+  }
+
+  for (std::size_t level = 0; level < L; ++level) {
+    const auto shift = W * level;
+    const auto tick = (deadline >> shift) << shift;
+    if (tick >= now && (deadline >> shift) - (now >> shift) < BUCKETS) {
+      return { level, (deadline >> shift) & MASK, tick };
+    }
+  }
+
+  // deadlines beyond the coarsest wheel's range are parked in its furthest
+  // bucket and placed again once that bucket is cascaded
+  const auto shift = W * (L - 1);
+  const auto slot = (now >> shift) + BUCKETS - 1;
+  return { L - 1, slot & MASK, slot << shift };
+}
+
+template <typename T, std::size_t O, std::size_t W, std::size_t L>
+  requires timer_c<T>
+bool delay_queue_t<T, O, W, L>::insert(pointer elem, std::uintmax_t now) {
+  auto at = place(static_cast<std::uintmax_t>(elem->deadline), now);
+  if (!this->m_wheels[at.level][at.slot].try_enqueue(elem)) {
+    // fall back to the bucket of the current tick, the timer is placed again
+    // once that bucket is processed
+    at = placement_t{ 0, now & MASK, now };
+    if (!this->m_wheels[0][at.slot].try_enqueue(elem)) {
+      return false;
+    }
+  }
+
+  // if the bucket's tick has been claimed in the meantime, the timer may have
+  // been missed and the bucket must be processed again
+  std::atomic_thread_fence(seq_cst);
+  if (this->m_tick.load(relaxed) > at.tick) {
+    this->mark_late(at);
+  }
+
+  return true;
+}
+
+template <typename T, std::size_t O, std::size_t W, std::size_t L>
+  requires timer_c<T>
+void delay_queue_t<T, O, W, L>::mark_late(placement_t at) {
+  (void) this->m_late.schedule(at.level * BUCKETS + at.slot);
+}
+
+template <typename T, std::size_t O, std::size_t W, std::size_t L>
+  requires timer_c<T>
+template <typename F>
+std::size_t delay_queue_t<T, O, W, L>::process_tick(std::uintmax_t tick, F& callback) {
+  std::size_t fired = 0;
+
+  // cascade the coarser wheels first, so their timers can still be placed in
+  // the finer wheels' buckets for this tick
+  for (auto level = L - 1; level > 0; --level) {
+    const auto shift = W * level;
+    if ((tick & ((std::uintmax_t{ 1 } << shift) - 1)) == 0) {
+      fired += this->process_bucket(level, (tick >> shift) & MASK, callback);
+    }
+  }
+
+  fired += this->process_bucket(0, tick & MASK, callback);
+  return fired;
+}
+
+template <typename T, std::size_t O, std::size_t W, std::size_t L>
+  requires timer_c<T>
+template <typename F>
+std::size_t delay_queue_t<T, O, W, L>::process_bucket(
+    std::size_t level,
+    std::size_t slot,
+    F& callback
+) {
+  std::size_t fired = 0;
+  auto& ring = this->m_wheels[level][slot];
+
+  // bounded, since timers may be re-queued into the same bucket
+  for (std::size_t i = 0; i < BUCKET_CAPACITY; ++i) {
+    pointer elem;
+    if (!ring.try_dequeue(elem)) {
+      break;
+    }
+
+    const auto now = this->m_tick.load(acquire);
+    if (static_cast<std::uintmax_t>(elem->deadline) < now) {
+      callback(elem);
+      fired += 1;
+      continue;
+    }
+
+    if (this->insert(elem, now)) {
+      continue;
+    }
+
+    // all eligible buckets are full, so the timer is kept in this bucket,
+    // which a later `advance` processes again
+    while (!ring.try_enqueue(elem)) {
+      // a concurrent schedule has taken the slot freed by the dequeue
+      if (this->insert(elem, this->m_tick.load(acquire))) {
+        break;
+      }
+
+      std::this_thread::yield();
+    }
+
+    this->mark_late(placement_t{ level, slot, now });
+    break;
+  }
+
+  return fired;
+}
+}
+
+#endif /* SCQ_DELAY_QUEUE_HPP */
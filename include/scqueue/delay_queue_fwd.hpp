@@ -0,0 +1,109 @@
+#ifndef SCQ_DELAY_QUEUE_FWD_HPP
+#define SCQ_DELAY_QUEUE_FWD_HPP
+
+#include <atomic>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+#include "scqueue/detail/ready_queue_fwd.hpp"
+#include "scqueue/scq2_fwd.hpp"
+
+namespace scq::timer {
+/** Timer elements must expose their deadline (in ticks) as `deadline`. */
+template <typename T>
+concept timer_c = requires(const T& timer) {
+  { timer.deadline } -> std::convertible_to<std::uintmax_t>;
+};
+
+/**
+ * A lock-free hierarchical timing wheel with `L` wheels of `2^W` buckets,
+ * each of which is an SCQ ring with a capacity of `2^O` timers.
+ *
+ * Buckets of wheel `k` cover `2^(W * k)` ticks each and are cascaded into the
+ * finer wheels once their first tick is reached.
+ * With the default parameters, the wheels take up 4 MiB, so the queue should
+ * not be placed on the stack.
+ */
+template <typename T, std::size_t O = 10, std::size_t W = 6, std::size_t L = 4>
+  requires timer_c<T>
+class delay_queue_t {
+public:
+  using pointer = T*;
+private:
+  static_assert(W >= 1 && L >= 1, "there must be at least one wheel with two buckets");
+  static_assert(W * L < std::numeric_limits<std::uintmax_t>::digits, "wheels exceed tick range");
+  /** size and bit constants */
+  static constexpr auto BUCKETS       = std::size_t{ 1 } << W;
+  static constexpr auto MASK          = BUCKETS - 1;
+  static constexpr auto LATE_ORDER    = W + std::bit_width(L - 1) < 3 ? 3 : W + std::bit_width(L - 1);
+  static constexpr auto LATE_CAPACITY = std::size_t{ 1 } << LATE_ORDER;
+  /** type aliases */
+  using ring_t       = ::scq::cas2::bounded_queue_t<T, O>;
+  using wheel_t      = std::array<ring_t, BUCKETS>;
+  using late_queue_t = detail::ready_queue_t<LATE_ORDER>;
+  /** memory ordering constants */
+  static constexpr auto relaxed = std::memory_order_relaxed;
+  static constexpr auto acquire = std::memory_order_acquire;
+  static constexpr auto seq_cst = std::memory_order_seq_cst;
+
+  /** The bucket a timer is placed in and the tick at which it is drained. */
+  struct placement_t {
+    std::size_t    level, slot;
+    std::uintmax_t tick;
+  };
+
+  static placement_t place(std::uintmax_t deadline, std::uintmax_t now) noexcept;
+
+  bool insert(pointer elem, std::uintmax_t now);
+  void mark_late(placement_t at);
+  template <typename F>
+  std::size_t process_tick(std::uintmax_t tick, F& callback);
+  template <typename F>
+  std::size_t process_bucket(std::size_t level, std::size_t slot, F& callback);
+
+  /** The next tick that has not yet been claimed for processing. */
+  alignas(128) std::atomic_uintmax_t m_tick;
+  /** The ids of buckets, which received timers after their tick had been claimed. */
+  late_queue_t m_late{ };
+  /** The wheels, from finest to coarsest. */
+  std::array<wheel_t, L> m_wheels{ };
+
+public:
+  /** the capacity of each individual bucket */
+  static constexpr auto BUCKET_CAPACITY = ring_t::CAPACITY;
+
+  /** constructor */
+  explicit delay_queue_t(std::uintmax_t start = 0) noexcept;
+  ~delay_queue_t() = default;
+
+  /**
+   * Schedules a timer to fire once its deadline tick has been reached,
+   * timers with passed deadlines fire with the next processed tick.
+   *
+   * @return true upon success, false if the timer's bucket is full
+   * @throws `std::invalid_argument` exception, if `elem` is `nullptr`
+   */
+  bool schedule(pointer elem);
+
+  /**
+   * Processes all ticks up to and including `now` and invokes `callback` for
+   * every expired timer, may be called by multiple threads concurrently.
+   *
+   * Timers that can not be re-queued while cascading, because all eligible
+   * buckets are full, are kept in their bucket and retried by later calls,
+   * so they may fire late, but never early.
+   *
+   * @return the number of timers passed to `callback`
+   */
+  template <typename F>
+  std::size_t advance(std::uintmax_t now, F&& callback);
+
+  /** Returns the next tick, which has not yet been processed. */
+  [[nodiscard]] std::uintmax_t next_tick() const noexcept;
+};
+}
+
+#endif /* SCQ_DELAY_QUEUE_FWD_HPP */
@@ -1,9 +1,26 @@
 #ifndef SCQ_DETAIL_HPP
 #define SCQ_DETAIL_HPP
 
+#include <array>
 #include <atomic>
+#include <bit>
 #include <compare>
+#include <cstdint>
+#include <functional>
 #include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+// the generic 16-byte atomics are implemented by libatomic, which must be
+// linked; they can be selected on x86-64 as well by defining
+// `SCQ_GENERIC_DWORD`
+#if defined(__x86_64__) && !defined(SCQ_GENERIC_DWORD)
+#define SCQ_X86_DWORD
+#endif
 
 #include <iostream>
 
@@ -21,22 +38,48 @@ struct finalize_bit_t<true> {
   static constexpr auto mask = ~bit;
 };
 
-struct cycle_t {
-  std::uintmax_t val;
+/** A cycle value of word type `W`, compared with wraparound. */
+template <typename W>
+struct basic_cycle_t {
+  W val;
+
+  static constexpr auto diff(const basic_cycle_t& lhs, const basic_cycle_t& rhs) noexcept {
+    return static_cast<std::make_signed_t<W>>(static_cast<W>(lhs.val - rhs.val));
+  }
 };
 
-constexpr auto operator<=(const cycle_t& lhs, const cycle_t& rhs) {
-  return static_cast<std::intmax_t>(lhs.val) - static_cast<std::intmax_t>(rhs.val) <= 0;
+using cycle_t = basic_cycle_t<std::uintmax_t>;
+
+template <typename W>
+constexpr auto operator<=(const basic_cycle_t<W>& lhs, const basic_cycle_t<W>& rhs) {
+  return basic_cycle_t<W>::diff(lhs, rhs) <= 0;
 }
 
-constexpr auto operator<(const cycle_t& lhs, const cycle_t& rhs) {
-  return static_cast<std::intmax_t>(lhs.val) - static_cast<std::intmax_t>(rhs.val) < 0;
+template <typename W>
+constexpr auto operator<(const basic_cycle_t<W>& lhs, const basic_cycle_t<W>& rhs) {
+  return basic_cycle_t<W>::diff(lhs, rhs) < 0;
 }
 
-constexpr auto operator>=(const cycle_t& lhs, const cycle_t& rhs) {
-  return static_cast<std::intmax_t>(lhs.val) - static_cast<std::intmax_t>(rhs.val) >= 0;
+template <typename W>
+constexpr auto operator>=(const basic_cycle_t<W>& lhs, const basic_cycle_t<W>& rhs) {
+  return basic_cycle_t<W>::diff(lhs, rhs) >= 0;
 }
 
+template <typename W>
+constexpr auto operator>(const basic_cycle_t<W>& lhs, const basic_cycle_t<W>& rhs) {
+  return basic_cycle_t<W>::diff(lhs, rhs) > 0;
+}
+
+/** Per-thread operation statistics collected by queue handles. */
+struct handle_stats_t {
+  /** number of successful operations */
+  std::size_t succeeded{ 0 };
+  /** number of failed operations (full or empty queue) */
+  std::size_t failed{ 0 };
+  /** number of times a cached index was insufficient and had to be reloaded */
+  std::size_t reloads{ 0 };
+};
+
 template <typename T>
 struct pair_t {
   using pointer = T*;
@@ -45,6 +88,508 @@ struct pair_t {
   pointer        ptr;
 };
 
+/** Returns the calling thread's stripe index, assigned round-robin on first use. */
+inline std::size_t thread_stripe() noexcept {
+  static std::atomic_size_t next{ 0 };
+  thread_local const auto stripe = next.fetch_add(1, std::memory_order_relaxed);
+  return stripe;
+}
+
+/**
+ * The empty-detection threshold of a queue, which bounds the number of failed
+ * dequeue attempts after the last enqueue.
+ *
+ * With `S == 1`, the threshold is a single counter, which every failed
+ * dequeue attempt decrements and every enqueue resets, if necessary.
+ */
+template <std::intmax_t THRESHOLD, std::size_t S = 1>
+class threshold_t {
+  alignas(128) std::atomic_intmax_t m_value;
+
+public:
+  explicit threshold_t(std::intmax_t init) noexcept : m_value{ init } {}
+
+  /** Returns true if the threshold is exhausted and the queue considered empty. */
+  [[nodiscard]] bool exhausted(std::memory_order order) const noexcept {
+    return this->m_value.load(order) < 0;
+  }
+
+  /** Decrements the threshold and returns true if it was already exhausted. */
+  bool decrement() noexcept {
+    return this->m_value.fetch_sub(1, std::memory_order_acq_rel) <= 0;
+  }
+
+  /** Resets the threshold after an enqueue, unless it is still untouched. */
+  void refresh(std::memory_order order) noexcept {
+    if (this->m_value.load(order) != THRESHOLD) {
+      this->reset(std::memory_order_release);
+    }
+  }
+
+  void reset(std::memory_order order) noexcept {
+    this->m_value.store(THRESHOLD, order);
+  }
+};
+
+/**
+ * The striped variant of the threshold with one counter per thread stripe.
+ *
+ * Failed dequeue attempts only decrement their own stripe's counter and set
+ * a shared dirty flag, if it is not already set, so the flag is written once
+ * per reset instead of once per failed attempt.
+ * Enqueues only reset the counters after observing the flag and the flag is
+ * only cleared after all counters have been reset, so an enqueue skipping
+ * the reset never leaves an exhausted stripe behind.
+ * A stripe can only be exhausted if at least as many failed attempts were
+ * made globally, and the total number of failed attempts after the last
+ * enqueue stays bounded by `S * THRESHOLD`, which preserves livelock-freedom.
+ */
+template <std::intmax_t THRESHOLD, std::size_t S>
+  requires (S > 1)
+class threshold_t<THRESHOLD, S> {
+  struct alignas(128) stripe_t {
+    std::atomic_intmax_t value;
+  };
+
+  stripe_t& local() noexcept {
+    return this->m_stripes[thread_stripe() % S];
+  }
+
+  const stripe_t& local() const noexcept {
+    return this->m_stripes[thread_stripe() % S];
+  }
+
+  alignas(128) std::atomic_bool   m_dirty;
+  std::array<stripe_t, S>         m_stripes;
+
+public:
+  explicit threshold_t(std::intmax_t init) noexcept : m_dirty{ init != THRESHOLD } {
+    for (auto& stripe : this->m_stripes) {
+      stripe.value.store(init, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] bool exhausted(std::memory_order order) const noexcept {
+    return this->local().value.load(order) < 0;
+  }
+
+  bool decrement() noexcept {
+    const auto prev = this->local().value.fetch_sub(1, std::memory_order_seq_cst);
+    if (!this->m_dirty.load(std::memory_order_seq_cst)) {
+      this->m_dirty.store(true, std::memory_order_release);
+    }
+
+    return prev <= 0;
+  }
+
+  /**
+   * Resets all stripes after an enqueue, if any has been decremented.
+   *
+   * An enqueue finding the flag already cleared must synchronize with the
+   * stripe resets of the enqueue that cleared it, so the flag is loaded with
+   * at least acquire ordering regardless of `order`.
+   */
+  void refresh([[maybe_unused]] std::memory_order order) noexcept {
+    if (!this->m_dirty.load(std::memory_order_acquire)) {
+      return;
+    }
+
+    // concurrent enqueues observing the flag all reset the counters, since
+    // none of them may return before the counters have been reset
+    this->reset(std::memory_order_release);
+    this->m_dirty.store(false, std::memory_order_seq_cst);
+
+    // a decrement after the reset may have found the flag still set, in which
+    // case it must be set again
+    for (const auto& stripe : this->m_stripes) {
+      if (stripe.value.load(std::memory_order_seq_cst) != THRESHOLD) {
+        this->m_dirty.store(true, std::memory_order_release);
+        break;
+      }
+    }
+  }
+
+  void reset(std::memory_order order) noexcept {
+    for (auto& stripe : this->m_stripes) {
+      stripe.value.store(THRESHOLD, order);
+    }
+  }
+};
+
+/**
+ * High/low watermark state of a queue.
+ *
+ * The state flips to "above" once an enqueue observes an occupancy of at least
+ * the high watermark, and back once a dequeue observes an occupancy of at most
+ * the low watermark.
+ * Each flip is performed by exactly one thread, which then re-reads the
+ * occupancy and flips the state back, if the occupancy it was based on has
+ * become stale in the meantime, since no opposite flip may follow otherwise.
+ *
+ * The callback is invoked by one thread at a time with alternating states,
+ * crossings that are undone before they are reported are coalesced.
+ */
+class watermark_t {
+public:
+  /** invoked with true when crossing the high and false when crossing the low watermark */
+  using callback_t = std::function<void(bool)>;
+
+  /** Configures the watermarks, must be called before the queue is shared. */
+  void configure(std::size_t low, std::size_t high, callback_t callback) {
+    if (low >= high) [[unlikely]] {
+      throw std::invalid_argument("low watermark must be less than high watermark");
+    }
+
+    this->m_low = static_cast<std::intmax_t>(low);
+    this->m_high = static_cast<std::intmax_t>(high);
+    this->m_callback = std::move(callback);
+  }
+
+  [[nodiscard]] bool enabled() const noexcept {
+    return this->m_high != 0;
+  }
+
+  [[nodiscard]] bool above() const noexcept {
+    return this->m_above.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Evaluates the occupancy observed by a successful enqueue, `reread` must
+   * return the queue's current occupancy.
+   */
+  template <typename F>
+  void after_enqueue(std::intmax_t occupancy, F&& reread) {
+    if (occupancy >= this->m_high && this->flip(false)) {
+      this->settle(true, reread);
+    }
+  }
+
+  /** Evaluates the occupancy observed by a successful dequeue, see `after_enqueue`. */
+  template <typename F>
+  void after_dequeue(std::intmax_t occupancy, F&& reread) {
+    if (occupancy <= this->m_low && this->flip(true)) {
+      this->settle(false, reread);
+    }
+  }
+
+private:
+  bool flip(bool expected) {
+    return this->m_above.load(std::memory_order_relaxed) == expected
+        && this->m_above.compare_exchange_strong(expected, !expected, std::memory_order_seq_cst);
+  }
+
+  /** Flips the state back for as long as the current occupancy contradicts it. */
+  template <typename F>
+  void settle(bool above, F& reread) {
+    while (true) {
+      const auto occupancy = reread();
+      const auto stale = above ? occupancy <= this->m_low : occupancy >= this->m_high;
+      // a failed flip means another thread has flipped and settles the state
+      if (!stale || !this->flip(above)) {
+        break;
+      }
+
+      above = !above;
+    }
+
+    if (this->m_callback) {
+      this->notify();
+    }
+  }
+
+  /** Reports the current state, unless another thread is already doing so. */
+  void notify() {
+    while (!this->m_notifying.exchange(true, std::memory_order_seq_cst)) {
+      auto reported = this->m_reported;
+      for (auto curr = this->above(); curr != reported; curr = this->above()) {
+        reported = curr;
+        this->m_callback(curr);
+      }
+
+      this->m_reported = reported;
+      this->m_notifying.store(false, std::memory_order_seq_cst);
+      // a flip after the last check was not reported by its thread, which
+      // found the flag still set
+      if (this->m_above.load(std::memory_order_seq_cst) == reported) {
+        break;
+      }
+    }
+  }
+
+  std::intmax_t     m_low{ 0 };
+  std::intmax_t     m_high{ 0 };
+  callback_t        m_callback{ };
+  std::atomic_bool  m_above{ false };
+  /** set while a thread is invoking the callback */
+  std::atomic_bool  m_notifying{ false };
+  /** the state last passed to the callback, guarded by `m_notifying` */
+  bool              m_reported{ false };
+};
+
+/**
+ * Parks consumers draining a closable queue until elements are enqueued or
+ * the queue is closed.
+ *
+ * A drainer registers before checking the queue a last time and then waits
+ * for the epoch to change, producers only bump the epoch and wake drainers
+ * while any are registered, so enqueues do not pay for a notification
+ * otherwise.
+ */
+class drain_signal_t {
+  alignas(128) std::atomic_uint32_t m_epoch{ 0 };
+  std::atomic_uint32_t              m_parked{ 0 };
+
+public:
+  /**
+   * Registers a drainer and returns the epoch to park on, the queue must be
+   * checked again before parking.
+   */
+  std::uint32_t prepare() noexcept {
+    this->m_parked.fetch_add(1, std::memory_order_seq_cst);
+    return this->m_epoch.load(std::memory_order_seq_cst);
+  }
+
+  /** Waits until the epoch has changed and withdraws the registration. */
+  void park(std::uint32_t epoch) noexcept {
+    this->m_epoch.wait(epoch, std::memory_order_acquire);
+    this->m_parked.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /** Withdraws the registration without parking. */
+  void cancel() noexcept {
+    this->m_parked.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /** Wakes all parked drainers, must be called after an enqueue or closing the queue. */
+  void notify() noexcept {
+    // pairs with the registration of drainers checking the queue concurrently
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (this->m_parked.load(std::memory_order_relaxed) != 0) {
+      this->m_epoch.fetch_add(1, std::memory_order_release);
+      this->m_epoch.notify_all();
+    }
+  }
+};
+
+/** Double-word integer type used for 16-byte atomic operations. */
+typedef unsigned __int128 __attribute__((__may_alias__)) dword_t;
+
+/** The CPU features relevant for 16-byte atomic operations. */
+struct cpu_features_t {
+  /**
+   * aligned 16-byte vector loads are atomic, which Intel and AMD document
+   * for all their CPUs supporting AVX
+   */
+  bool avx_loads;
+  /** the `cmpxchg16b` instruction is available */
+  bool cx16;
+
+  static cpu_features_t detect() noexcept {
+#if defined(__x86_64__)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+      return { false, false };
+    }
+
+    const auto cx16 = (ecx & bit_CMPXCHG16B) != 0;
+    // AVX instructions also require the OS to save the extended register state
+    if ((ecx & bit_AVX) == 0 || (ecx & bit_OSXSAVE) == 0 || !atomic_vendor()) {
+      return { false, cx16 };
+    }
+
+    std::uint32_t xcr0_lo, xcr0_hi;
+    asm("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    return { (xcr0_lo & 0b110) == 0b110, cx16 };
+#else
+    return { false, false };
+#endif
+  }
+
+  /** Returns true if the CPU vendor guarantees atomic 16-byte AVX loads. */
+  static bool atomic_vendor() noexcept {
+#if defined(__x86_64__)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(0, &eax, &ebx, &ecx, &edx) == 0) {
+      return false;
+    }
+
+    return (
+        ebx == signature_INTEL_ebx && ecx == signature_INTEL_ecx && edx == signature_INTEL_edx
+    ) || (
+        ebx == signature_AMD_ebx && ecx == signature_AMD_ecx && edx == signature_AMD_edx
+    );
+#else
+    return false;
+#endif
+  }
+};
+
+/** The features of the executing CPU, detected once at start-up. */
+inline const cpu_features_t cpu_features = cpu_features_t::detect();
+
+/**
+ * Returns true if 16-byte values must be accessed under a `dword_lock_t`,
+ * because the executing CPU lacks the `cmpxchg16b` instruction.
+ */
+inline bool dword_locked() noexcept {
+#if defined(SCQ_X86_DWORD)
+  return !cpu_features.cx16;
+#else
+  return false;
+#endif
+}
+
+/**
+ * A spin lock from a fixed set of stripes, selected by address.
+ *
+ * Serializes all accesses to a 16-byte value, including those to its single
+ * words, while `dword_locked()` is true.
+ */
+class dword_lock_t {
+  struct alignas(128) stripe_t {
+    std::atomic_bool locked;
+  };
+
+  static inline std::array<stripe_t, 64> stripes{ };
+
+  stripe_t& m_stripe;
+
+public:
+  explicit dword_lock_t(const void* addr) noexcept :
+    m_stripe{ stripes[(reinterpret_cast<std::uintptr_t>(addr) >> 4) % stripes.size()] }
+  {
+    while (this->m_stripe.locked.exchange(true, std::memory_order_acquire)) {
+      while (this->m_stripe.locked.load(std::memory_order_relaxed));
+    }
+  }
+
+  dword_lock_t(const dword_lock_t&) = delete;
+  dword_lock_t& operator=(const dword_lock_t&) = delete;
+
+  ~dword_lock_t() {
+    this->m_stripe.locked.store(false, std::memory_order_release);
+  }
+};
+
+/**
+ * Performs a 16-byte compare-and-swap, writing the current value into
+ * `expected` on failure.
+ *
+ * On x86-64, every locked instruction is a full barrier, so the memory order
+ * arguments are only relevant for the generic implementation, which requires
+ * libatomic.
+ * CPUs without `cmpxchg16b` are detected at start-up and use a striped lock
+ * instead.
+ */
+inline bool dwcas(
+    dword_t* dst,
+    dword_t& expected,
+    dword_t desired,
+    std::memory_order success,
+    std::memory_order failure
+) noexcept {
+#if defined(SCQ_X86_DWORD)
+  (void) success;
+  (void) failure;
+  if (dword_locked()) [[unlikely]] {
+    const auto lock = dword_lock_t{ dst };
+    const auto curr = *dst;
+    if (curr == expected) {
+      *dst = desired;
+      return true;
+    }
+
+    expected = curr;
+    return false;
+  }
+
+#  if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+  const auto prev = __sync_val_compare_and_swap(dst, expected, desired);
+  if (prev == expected) {
+    return true;
+  }
+
+  expected = prev;
+  return false;
+#  else
+  // without -mcx16 the builtins would call into libatomic, so the
+  // instruction is emitted directly
+  auto lo = static_cast<std::uint64_t>(expected);
+  auto hi = static_cast<std::uint64_t>(expected >> 64);
+  bool res;
+  asm volatile(
+    "lock cmpxchg16b %0"
+    : "+m"(*dst), "=@ccz"(res), "+a"(lo), "+d"(hi)   // output ops
+    : "b"(static_cast<std::uint64_t>(desired)),      // input ops
+      "c"(static_cast<std::uint64_t>(desired >> 64))
+    : "memory"                                       // clobbers
+  );
+
+  expected = (dword_t{ hi } << 64) | lo;
+  return res;
+#  endif
+#else
+  return __atomic_compare_exchange_n(
+      dst, &expected, desired, true, static_cast<int>(success), static_cast<int>(failure)
+  );
+#endif
+}
+
+/** Performs an atomic 16-byte load. */
+inline dword_t dwload(const dword_t* src, std::memory_order order) noexcept {
+#if defined(SCQ_X86_DWORD)
+  if (dword_locked()) [[unlikely]] {
+    const auto lock = dword_lock_t{ src };
+    return *src;
+  }
+
+  if (cpu_features.avx_loads) [[likely]] {
+    std::uint64_t lo, hi;
+    asm volatile(
+      "vmovdqa %2, %%xmm0\n\t"
+      "vmovq %%xmm0, %0\n\t"
+      "vpextrq $1, %%xmm0, %1"
+      : "=r"(lo), "=r"(hi)  // output ops
+      : "m"(*src)           // input ops
+      : "xmm0", "memory"    // clobbers
+    );
+
+    return (dword_t{ hi } << 64) | lo;
+  }
+
+  // a failed (or identity) CAS returns the current value atomically
+  auto expected = dword_t{ 0 };
+  (void) dwcas(const_cast<dword_t*>(src), expected, expected, order, order);
+  return expected;
+#else
+  return __atomic_load_n(const_cast<dword_t*>(src), static_cast<int>(order));
+#endif
+}
+
+/** Atomically applies a bitwise AND to a 16-byte value and returns the previous value. */
+inline dword_t dwfetch_and(dword_t* dst, dword_t mask, std::memory_order order) noexcept {
+#if defined(SCQ_X86_DWORD)
+  // x86-64 has no 16-byte fetch-and, but starting from an untorn value makes
+  // the first CAS succeed unless there is actual contention
+  auto curr = dwload(dst, std::memory_order_relaxed);
+  while (!dwcas(dst, curr, curr & mask, order, std::memory_order_relaxed));
+  return curr;
+#else
+  return __atomic_fetch_and(dst, mask, static_cast<int>(order));
+#endif
+}
+
+/** Atomically applies a bitwise OR to a 16-byte value and returns the previous value. */
+inline dword_t dwfetch_or(dword_t* dst, dword_t mask, std::memory_order order) noexcept {
+#if defined(SCQ_X86_DWORD)
+  auto curr = dwload(dst, std::memory_order_relaxed);
+  while (!dwcas(dst, curr, curr | mask, order, std::memory_order_relaxed));
+  return curr;
+#else
+  return __atomic_fetch_or(dst, mask, static_cast<int>(order));
+#endif
+}
+
 template <typename T>
 struct alignas(16) atomic_pair_t {
   using pointer = T*;
@@ -52,46 +597,102 @@ struct alignas(16) atomic_pair_t {
   std::atomic<std::uintmax_t> tag{ 0 };
   std::atomic<pointer>        ptr{ nullptr };
 
+  pair_t<T> load(std::memory_order order) const noexcept {
+    return std::bit_cast<pair_t<T>>(dwload(this->raw(), order));
+  }
+
   bool compare_exchange_weak(
       pair_t<T>& expected,
       pair_t<T>  desired,
       std::memory_order success,
       std::memory_order failure
-  ) {
-    (void) success;
-    (void) failure;
-    uint8_t res;
-    asm volatile(
-      "lock cmpxchg16b %0"
-      : "+m"(*this), "=@ccz"(res), "+a"(expected.tag), "+d"(expected.ptr) // input ops
-      : "b"(desired.tag), "c"(desired.ptr)                                // output ops
-      : "memory"                                                          // clobbers
+  ) noexcept {
+    auto raw_expected = std::bit_cast<dword_t>(expected);
+    const auto res = dwcas(
+        this->raw(),
+        raw_expected,
+        std::bit_cast<dword_t>(desired),
+        success,
+        failure
     );
 
-    return res != 0;
+    expected = std::bit_cast<pair_t<T>>(raw_expected);
+    return res;
   }
 
-  pair_t<T> fetch_and(pair_t<T> pair, std::memory_order order) {
-    auto curr = pair_t {
-      this->tag.load(std::memory_order_relaxed),
-      this->ptr.load(std::memory_order_relaxed)
-    };
+  pair_t<T> fetch_and(pair_t<T> pair, std::memory_order order) noexcept {
+    const auto prev = dwfetch_and(this->raw(), std::bit_cast<dword_t>(pair), order);
+    return std::bit_cast<pair_t<T>>(prev);
+  }
 
-    while (true) {
-      const auto next = pair_t {
-          curr.tag & pair.tag,
-          reinterpret_cast<pointer>(
-              reinterpret_cast<std::uintptr_t>(curr.ptr)
-              & reinterpret_cast<std::uintptr_t>(pair.ptr)
-          )
-      };
-
-      if (this->compare_exchange_weak(curr, next, order, std::memory_order_relaxed)) {
-        return curr;
-      }
+  pair_t<T> fetch_or(pair_t<T> pair, std::memory_order order) noexcept {
+    const auto prev = dwfetch_or(this->raw(), std::bit_cast<dword_t>(pair), order);
+    return std::bit_cast<pair_t<T>>(prev);
+  }
+
+  /**
+   * Single-word accesses, which must be used instead of accessing `tag` and
+   * `ptr` directly once the pair is shared, so they are serialized with the
+   * locked 16-byte operations if necessary.
+   */
+  std::uintmax_t load_tag(std::memory_order order) const noexcept {
+    if (dword_locked()) [[unlikely]] {
+      const auto lock = dword_lock_t{ this };
+      return this->tag.load(std::memory_order_relaxed);
+    }
+
+    return this->tag.load(order);
+  }
+
+  pointer load_ptr(std::memory_order order) const noexcept {
+    if (dword_locked()) [[unlikely]] {
+      const auto lock = dword_lock_t{ this };
+      return this->ptr.load(std::memory_order_relaxed);
     }
+
+    return this->ptr.load(order);
+  }
+
+  std::uintmax_t fetch_and_tag(std::uintmax_t mask, std::memory_order order) noexcept {
+    if (dword_locked()) [[unlikely]] {
+      const auto lock = dword_lock_t{ this };
+      return this->tag.fetch_and(mask, std::memory_order_relaxed);
+    }
+
+    return this->tag.fetch_and(mask, order);
+  }
+
+  bool compare_exchange_tag_weak(
+      std::uintmax_t& expected,
+      std::uintmax_t desired,
+      std::memory_order success,
+      std::memory_order failure
+  ) noexcept {
+    if (dword_locked()) [[unlikely]] {
+      const auto lock = dword_lock_t{ this };
+      return this->tag.compare_exchange_strong(
+          expected,
+          desired,
+          std::memory_order_relaxed,
+          std::memory_order_relaxed
+      );
+    }
+
+    return this->tag.compare_exchange_weak(expected, desired, success, failure);
+  }
+
+private:
+  dword_t* raw() noexcept {
+    return reinterpret_cast<dword_t*>(this);
+  }
+
+  const dword_t* raw() const noexcept {
+    return reinterpret_cast<const dword_t*>(this);
   }
 };
+
+static_assert(sizeof(atomic_pair_t<void>) == sizeof(dword_t));
+static_assert(sizeof(pair_t<void>) == sizeof(dword_t));
 }
 
 #endif /* SCQ_DETAIL_HPP */
@@ -0,0 +1,39 @@
+#ifndef SCQ_READY_QUEUE_HPP
+#define SCQ_READY_QUEUE_HPP
+
+#include "scqueue/detail/ready_queue_fwd.hpp"
+#include "scqueue/detail/scq1.hpp"
+
+namespace scq::detail {
+template <std::size_t O>
+bool ready_queue_t<O>::scheduled(std::size_t id, std::memory_order order) const noexcept {
+  return this->m_flags[id].scheduled.load(order);
+}
+
+template <std::size_t O>
+bool ready_queue_t<O>::schedule(std::size_t id) {
+  if (this->m_flags[id].scheduled.exchange(true, std::memory_order_acq_rel)) {
+    return false;
+  }
+
+  (void) this->m_ids.try_enqueue(id);
+  return true;
+}
+
+template <std::size_t O>
+bool ready_queue_t<O>::try_dequeue(std::size_t& id) {
+  return this->m_ids.try_dequeue(id);
+}
+
+template <std::size_t O>
+void ready_queue_t<O>::requeue(std::size_t id) {
+  (void) this->m_ids.try_enqueue(id);
+}
+
+template <std::size_t O>
+void ready_queue_t<O>::unschedule(std::size_t id, std::memory_order order) {
+  this->m_flags[id].scheduled.store(false, order);
+}
+}
+
+#endif /* SCQ_READY_QUEUE_HPP */
@@ -0,0 +1,47 @@
+#ifndef SCQ_READY_QUEUE_FWD_HPP
+#define SCQ_READY_QUEUE_FWD_HPP
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+#include "scqueue/detail/scq1_fwd.hpp"
+
+namespace scq::detail {
+/**
+ * A queue of ids in the range `[0, 2^O)` with a flag per id, which is set
+ * while the id is scheduled, i.e., queued or held by the thread that dequeued
+ * it.
+ *
+ * Only the thread setting an id's flag queues it, so each id is queued at
+ * most once and the underlying ring, which has room for every id, can never
+ * overflow.
+ */
+template <std::size_t O>
+class ready_queue_t {
+  using index_queue_t = ::scq::cas1::bounded_index_queue_t<O, false, std::uint32_t>;
+
+  struct alignas(128) flag_t {
+    std::atomic_bool scheduled;
+  };
+
+  /** The ids of scheduled, but not yet dequeued ids. */
+  index_queue_t m_ids{ index_queue_t::EMPTY };
+  /** The scheduled flags. */
+  std::array<flag_t, std::size_t{ 1 } << O> m_flags{ };
+
+public:
+  /** Returns true if the id is scheduled. */
+  [[nodiscard]] bool scheduled(std::size_t id, std::memory_order order) const noexcept;
+  /** Schedules the id, unless it is already scheduled, and returns true if it was queued. */
+  bool schedule(std::size_t id);
+  /** Attempts to dequeue a scheduled id, which remains scheduled. */
+  bool try_dequeue(std::size_t& id);
+  /** Queues a dequeued id again, which must still be scheduled. */
+  void requeue(std::size_t id);
+  /** Clears the flag of a dequeued id, so it can be scheduled again. */
+  void unschedule(std::size_t id, std::memory_order order);
+};
+}
+
+#endif /* SCQ_READY_QUEUE_FWD_HPP */
@@ -3,13 +3,14 @@
 
 #include "scq1_fwd.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 using namespace std;
 
 namespace scq::cas1 {
-template <std::size_t O, bool finalize>
-bounded_index_queue_t<O, finalize>::bounded_index_queue_t(queue_init_t init) :
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+bounded_index_queue_t<O, finalize, W, S>::bounded_index_queue_t(queue_init_t init) :
     m_head{ init.deq_count },
     m_tail{ init.enq_count },
     m_threshold{ init.is_empty() ? -1 : THRESHOLD }
@@ -20,11 +21,11 @@ bounded_index_queue_t<O, finalize>::bounded_index_queue_t(queue_init_t init) :
   }
 
   for (auto i = 0; i < deq_count; ++i) {
-    this->m_slots[cache_remap(i)].store(2 * N - 1, relaxed);
+    this->m_slots[cache_remap(i)].store(CYCLE_MASK, relaxed);
   }
 
   for (auto i = deq_count; i < enq_count; ++i) {
-    this->m_slots[cache_remap(i)].store(N + i, relaxed);
+    this->m_slots[cache_remap(i)].store(static_cast<W>(N + i), relaxed);
   }
 
   for (auto i = enq_count; i < N; ++i) {
@@ -32,8 +33,8 @@ bounded_index_queue_t<O, finalize>::bounded_index_queue_t(queue_init_t init) :
   }
 }
 
-template <std::size_t O, bool finalize>
-bool bounded_index_queue_t<O, finalize>::try_enqueue(
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_index_queue_t<O, finalize, W, S>::try_enqueue(
     std::size_t idx,
     bool ignore_empty
 ) {
@@ -41,8 +42,15 @@ bool bounded_index_queue_t<O, finalize>::try_enqueue(
     throw std::invalid_argument("idx must not be greater than capacity");
   }
 
-  const auto enq_idx = static_cast<std::uintmax_t>(idx) ^ (N - 1);
+  const auto enq_idx = static_cast<W>(idx ^ (N - 1));
   while (true) {
+    if constexpr (finalize) {
+      // avoids incrementing the tail of a finalized queue in most cases
+      if ((this->m_tail.load(relaxed) & finalize_bit_t::bit) != 0) [[unlikely]] {
+        return false;
+      }
+    }
+
     const auto tail = this->m_tail.fetch_add(1, acq_rel);
     if constexpr (finalize) {
       if ((tail & finalize_bit_t::bit) != 0) [[unlikely]] {
@@ -50,18 +58,18 @@ bool bounded_index_queue_t<O, finalize>::try_enqueue(
       }
     }
 
-    const auto tail_cycle = cycle_t{ (tail << 1) | (2 * N - 1) };
+    const auto tail_cycle = slot_cycle_t{ static_cast<W>((tail << 1) | CYCLE_MASK) };
     auto& slot = this->m_slots[cache_remap(tail)];
     auto entry = slot.load(acquire);
 
     while (true) {
-      const auto entry_cycle = cycle_t{ entry | 2 * N - 1 };
+      const auto entry_cycle = slot_cycle_t{ static_cast<W>(entry | CYCLE_MASK) };
       if (
           entry_cycle < tail_cycle
           && (
               entry == entry_cycle.val
               || (
-                  (entry == (entry_cycle.val ^ N))
+                  (entry == static_cast<W>(entry_cycle.val ^ N))
                   && cycle_t{ this->m_head.load(acquire) } <= cycle_t{ tail }
               )
           )
@@ -70,8 +78,8 @@ bool bounded_index_queue_t<O, finalize>::try_enqueue(
           continue;
         }
 
-        if (!ignore_empty && (this->m_threshold.load(acquire) != THRESHOLD)) {
-          this->reset_threshold(release);
+        if (!ignore_empty) {
+          this->m_threshold.refresh(acquire);
         }
 
         return true;
@@ -82,82 +90,175 @@ bool bounded_index_queue_t<O, finalize>::try_enqueue(
   }
 }
 
-template <std::size_t O, bool finalize>
-bool bounded_index_queue_t<O, finalize>::try_dequeue(
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_index_queue_t<O, finalize, W, S>::try_dequeue(
     std::size_t& idx,
     bool ignore_empty
 ) noexcept {
-  if (!ignore_empty && this->m_threshold.load(acquire) < 0) {
+  if (!ignore_empty && this->m_threshold.exhausted(acquire)) {
     return false;
   }
 
   auto attempt = 0;
   while (true) {
     const auto head = this->m_head.fetch_add(1, acq_rel);
-    const auto head_cycle = cycle_t{ (head << 1) | (2 * N - 1) };
-    auto& slot = this->m_slots[cache_remap(head)];
-
-    std::uintmax_t entry, entry_new;
-    cycle_t entry_cycle;
-
-    retry:
-    entry = slot.load(acquire);
-    do {
-      entry_cycle = cycle_t{ entry | (2 * N - 1) };
-      if (entry_cycle.val == head_cycle.val) {
-        slot.fetch_or(N - 1, acq_rel);
-        idx = entry % N;
-        return true;
-      }
-
-      if ((entry | N) != entry_cycle.val) {
-        entry_new = entry & ~N;
-        if (entry == entry_new) {
-          break;
-        }
-      } else {
-        if (++attempt <= 10'000) {
-          goto retry;
-        }
-
-        entry_new = head_cycle.val ^ (~entry & N);
-      }
-    } while (
-        entry_cycle < head_cycle
-        && !slot.compare_exchange_weak(entry, entry_new, acq_rel, acquire)
-    );
+    if (this->consume_slot(head, idx, attempt)) {
+      return true;
+    }
 
     if (!ignore_empty) {
       const auto tail = this->m_tail.load(acquire);
       if (cycle_t{ tail & finalize_bit_t::mask } <= cycle_t{ head + 1 }) {
         this->catchup(tail, head + 1);
-        this->m_threshold.fetch_sub(1, acq_rel);
+        (void) this->m_threshold.decrement();
         return false;
       }
 
-      if (this->m_threshold.fetch_sub(1, acq_rel) <= 0) {
+      if (this->m_threshold.decrement()) {
         return false;
       }
     }
   }
 }
 
-template <std::size_t O, bool finalize>
-void bounded_index_queue_t<O, finalize>::finalize_queue() noexcept
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_index_queue_t<O, finalize, W, S>::consume_slot(
+    std::uintmax_t head,
+    std::size_t& idx,
+    int& attempt
+) noexcept {
+  const auto head_cycle = slot_cycle_t{ static_cast<W>((head << 1) | CYCLE_MASK) };
+  auto& slot = this->m_slots[cache_remap(head)];
+
+  W entry, entry_new;
+  slot_cycle_t entry_cycle;
+
+  retry:
+  entry = slot.load(acquire);
+  do {
+    entry_cycle = slot_cycle_t{ static_cast<W>(entry | CYCLE_MASK) };
+    if (entry_cycle.val == head_cycle.val) {
+      slot.fetch_or(static_cast<W>(N - 1), acq_rel);
+      idx = entry % N;
+      return true;
+    }
+
+    if (static_cast<W>(entry | N) != entry_cycle.val) {
+      entry_new = static_cast<W>(entry & ~N);
+      if (entry == entry_new) {
+        break;
+      }
+    } else {
+      if (++attempt <= 10'000) {
+        goto retry;
+      }
+
+      entry_new = static_cast<W>(head_cycle.val ^ (~entry & N));
+    }
+  } while (
+      entry_cycle < head_cycle
+      && !slot.compare_exchange_weak(entry, entry_new, acq_rel, acquire)
+  );
+
+  return false;
+}
+
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+template <typename F>
+std::size_t bounded_index_queue_t<O, finalize, W, S>::try_dequeue_bulk(
+    std::size_t max,
+    F&& callback
+) {
+  if (max == 0 || this->m_threshold.exhausted(acquire)) {
+    return 0;
+  }
+
+  const auto head = this->m_head.load(acquire);
+  const auto tail = this->m_tail.load(acquire) & finalize_bit_t::mask;
+  const auto avail = static_cast<std::intmax_t>(tail - head);
+  if (avail <= 0) {
+    // defer to a regular dequeue, which takes care of the empty detection
+    std::size_t idx;
+    if (!this->try_dequeue(idx)) {
+      return 0;
+    }
+
+    callback(idx);
+    return 1;
+  }
+
+  // claim all apparently filled indices at once
+  const auto count = std::min(max, static_cast<std::size_t>(avail));
+  const auto first = this->m_head.fetch_add(count, acq_rel);
+
+  std::size_t dequeued = 0;
+  auto attempt = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    std::size_t idx;
+    if (this->consume_slot(first + i, idx, attempt)) {
+      callback(idx);
+      dequeued += 1;
+    } else {
+      (void) this->m_threshold.decrement();
+    }
+  }
+
+  // concurrent dequeues may have pushed the head beyond the tail
+  const auto last = this->m_tail.load(acquire);
+  if (cycle_t{ last & finalize_bit_t::mask } <= cycle_t{ first + count }) {
+    this->catchup(last, first + count);
+  }
+
+  return dequeued;
+}
+
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_index_queue_t<O, finalize, W, S>::closed_and_empty() const noexcept {
+  const auto closed_tail = this->m_closed_tail.load(acquire);
+  if (closed_tail == OPEN_TAIL) {
+    return false;
+  }
+
+  // enqueues in progress have claimed their tail index before the queue was
+  // finalized, so the queue is empty once the head has passed all of them
+  return cycle_t{ closed_tail } <= cycle_t{ this->m_head.load(acquire) };
+}
+
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_index_queue_t<O, finalize, W, S>::finalize_queue() noexcept
   requires finalize
 {
-  this->m_tail.fetch_or(finalize_bit_t::bit, release);
+  const auto tail = this->m_tail.fetch_or(finalize_bit_t::bit, acq_rel);
+  if ((tail & finalize_bit_t::bit) == 0) {
+    this->m_closed_tail.store(tail, release);
+  }
 }
 
-template <std::size_t O, bool finalize>
-void bounded_index_queue_t<O, finalize>::reset_threshold(
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_index_queue_t<O, finalize, W, S>::reset_threshold(
     std::memory_order order
 ) noexcept {
-  this->m_threshold.store(THRESHOLD, order);
+  this->m_threshold.reset(order);
+}
+
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+std::intmax_t bounded_index_queue_t<O, finalize, W, S>::approx_size() const noexcept {
+  const auto head = this->m_head.load(relaxed);
+  auto tail = this->m_tail.load(relaxed) & finalize_bit_t::mask;
+  if constexpr (finalize) {
+    const auto closed_tail = this->m_closed_tail.load(relaxed);
+    if (closed_tail != OPEN_TAIL) {
+      // failed dequeues may have moved the head beyond the closed tail
+      tail = cycle_t{ closed_tail } < cycle_t{ tail } ? closed_tail : tail;
+      return cycle_t{ tail } <= cycle_t{ head } ? 0 : static_cast<std::intmax_t>(tail - head);
+    }
+  }
+
+  return static_cast<std::intmax_t>(tail - head);
 }
 
-template <std::size_t O, bool finalize>
-void bounded_index_queue_t<O, finalize>::catchup(uint64_t tail, uint64_t head) noexcept {
+template <std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_index_queue_t<O, finalize, W, S>::catchup(uint64_t tail, uint64_t head) noexcept {
   const auto finalize_bit = tail & finalize_bit_t::bit;
   while (!this->m_tail.compare_exchange_weak(tail, head | finalize_bit, acq_rel, acquire)) {
     head = this->m_head.load(acquire);
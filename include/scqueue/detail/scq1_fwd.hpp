@@ -5,13 +5,34 @@
 #include <array>
 #include <cstdint>
 #include <limits>
+#include <type_traits>
 
 #include "scqueue/detail/detail.hpp"
 
 namespace scq::cas1 {
-template <std::size_t O = 16, bool finalize = false>
+/**
+ * A bounded queue of indices in the range `[0, 2^O)`.
+ *
+ * @tparam W the unsigned word type of each slot, a narrower type such as
+ *   `std::uint32_t` reduces the queue's footprint, as long as enough bits
+ *   remain for the slots' cycles; cycles are compared with wraparound, which
+ *   is safe unless a thread is stalled for more than 2^(bits - 2) operations
+ * @tparam S the number of stripes of the empty-detection threshold, see
+ *   `scq::detail::threshold_t`
+ */
+template <
+    std::size_t O = 16,
+    bool finalize = false,
+    typename W = std::uintmax_t,
+    std::size_t S = 1
+>
 class bounded_index_queue_t {
   static_assert(O >= 2, "order must be greater than 2");
+  static_assert(std::is_unsigned_v<W>, "slot word type must be unsigned");
+  static_assert(
+      O + 2 + 8 <= std::numeric_limits<W>::digits,
+      "slot word type must leave at least 8 bits for the cycle"
+  );
   /** constructor argument type */
   struct queue_init_t {
     std::size_t deq_count, enq_count;
@@ -23,11 +44,15 @@ class bounded_index_queue_t {
   static constexpr auto HALF       = std::size_t{ 1 } << O;
   static constexpr auto N          = 2 * HALF;
   static constexpr auto THRESHOLD  = 3 * std::intmax_t{ N } - 1;
-  static constexpr auto EMPTY_SLOT = std::numeric_limits<std::uintmax_t>::max();
+  static constexpr auto EMPTY_SLOT = std::numeric_limits<W>::max();
+  static constexpr auto CYCLE_MASK = static_cast<W>(2 * N - 1);
+  static constexpr auto OPEN_TAIL  = std::numeric_limits<std::uintmax_t>::max();
   /** type aliases */
   using cycle_t        = scq::detail::cycle_t;
+  using slot_cycle_t   = scq::detail::basic_cycle_t<W>;
   using finalize_bit_t = scq::detail::finalize_bit_t<finalize>;
-  using slot_array_t   = std::array<std::atomic_uintmax_t, N>;
+  using slot_array_t   = std::array<std::atomic<W>, N>;
+  using threshold_t    = scq::detail::threshold_t<THRESHOLD, S>;
   /** memory ordering constants */
   static constexpr auto relaxed = std::memory_order_relaxed;
   static constexpr auto acquire = std::memory_order_acquire;
@@ -40,10 +65,13 @@ class bounded_index_queue_t {
   }
 
   void catchup(std::uintmax_t tail, std::uintmax_t head) noexcept;
+  bool consume_slot(std::uintmax_t head, std::size_t& idx, int& attempt) noexcept;
 
   alignas(128) std::atomic_uintmax_t m_head;
   alignas(128) std::atomic_uintmax_t m_tail;
-  alignas(128) std::atomic_intmax_t  m_threshold;
+  /** The tail at the time the queue was finalized, rejected enqueues still increment `m_tail`. */
+  std::atomic_uintmax_t              m_closed_tail{ OPEN_TAIL };
+  alignas(128) threshold_t           m_threshold;
   alignas(128) slot_array_t          m_slots{ };
 
 public:
@@ -61,10 +89,20 @@ public:
   bool try_enqueue(std::size_t idx, bool ignore_empty = false);
   /** Attempts to dequeue the index at the queue's front. */
   bool try_dequeue(std::size_t& idx, bool ignore_empty = false) noexcept;
+  /**
+   * Attempts to dequeue up to `max` indices by advancing the head for all of
+   * them at once and passes each of them to `callback`.
+   */
+  template <typename F>
+  std::size_t try_dequeue_bulk(std::size_t max, F&& callback);
   /** Finalizes the queue, closing it for further enqueues. */
   void finalize_queue() noexcept requires finalize;
+  /** Returns true if the queue is finalized and all its indices have been dequeued. */
+  [[nodiscard]] bool closed_and_empty() const noexcept;
   /** Resets the threshold value. */
   void reset_threshold(std::memory_order order) noexcept;
+  /** Returns the number of enqueued indices, which may be stale under contention. */
+  [[nodiscard]] std::intmax_t approx_size() const noexcept;
 };
 }
 
@@ -0,0 +1,82 @@
+#ifndef SCQ_PARTITIONED_QUEUE_HPP
+#define SCQ_PARTITIONED_QUEUE_HPP
+
+#include "scqueue/partitioned_queue_fwd.hpp"
+#include "scqueue/detail/ready_queue.hpp"
+#include "scqueue/scq2.hpp"
+
+namespace scq::partition {
+template <typename T, std::size_t P, std::size_t O>
+bool partitioned_queue_t<T, P, O>::try_enqueue(std::size_t key, pointer elem) {
+  const auto partition = partition_of(key);
+  if (!this->m_partitions[partition].try_enqueue(elem)) {
+    return false;
+  }
+
+  this->schedule(partition);
+  return true;
+}
+
+template <typename T, std::size_t P, std::size_t O>
+bool partitioned_queue_t<T, P, O>::try_claim(std::size_t& partition) {
+  return this->m_ready.try_dequeue(partition);
+}
+
+template <typename T, std::size_t P, std::size_t O>
+bool partitioned_queue_t<T, P, O>::try_dequeue(
+    std::size_t partition,
+    pointer& result
+) noexcept {
+  return this->m_partitions[partition].try_dequeue(result);
+}
+
+template <typename T, std::size_t P, std::size_t O>
+void partitioned_queue_t<T, P, O>::release(std::size_t partition) {
+  auto& ring = this->m_partitions[partition];
+  if (ring.approx_size() > 0) {
+    // the partition remains scheduled and is handed on to the next consumer
+    this->m_ready.requeue(partition);
+    return;
+  }
+
+  // an element enqueued before the flag is cleared must not be missed, since
+  // its producer will have found the partition still scheduled
+  this->m_ready.unschedule(partition, std::memory_order_release);
+  std::atomic_thread_fence(seq_cst);
+  if (ring.approx_size() > 0) {
+    this->schedule(partition);
+  }
+}
+
+template <typename T, std::size_t P, std::size_t O>
+template <typename F>
+std::size_t partitioned_queue_t<T, P, O>::drain_batch(std::size_t max, F&& callback) {
+  std::size_t partition;
+  if (!this->try_claim(partition)) {
+    return 0;
+  }
+
+  std::size_t count = 0;
+  pointer elem;
+  while (count < max && this->try_dequeue(partition, elem)) {
+    callback(elem);
+    count += 1;
+  }
+
+  this->release(partition);
+  return count;
+}
+
+template <typename T, std::size_t P, std::size_t O>
+void partitioned_queue_t<T, P, O>::schedule(std::size_t partition) {
+  std::atomic_thread_fence(seq_cst);
+  // the fence pairs with the one in `release`, so a partition found still
+  // scheduled is guaranteed to be checked again by its consumer, which
+  // avoids contending on the flag for every element
+  if (!this->m_ready.scheduled(partition, relaxed)) {
+    (void) this->m_ready.schedule(partition);
+  }
+}
+}
+
+#endif /* SCQ_PARTITIONED_QUEUE_HPP */
@@ -0,0 +1,92 @@
+#ifndef SCQ_PARTITIONED_QUEUE_FWD_HPP
+#define SCQ_PARTITIONED_QUEUE_FWD_HPP
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+#include "scqueue/detail/ready_queue_fwd.hpp"
+#include "scqueue/scq2_fwd.hpp"
+
+namespace scq::partition {
+/**
+ * A queue of `2^P` partitions with a capacity of `2^O` elements each, which
+ * preserves the FIFO order of elements with the same key while elements with
+ * different keys can be consumed in parallel.
+ *
+ * Keys are mapped onto partitions by hashing and consumers claim exclusive
+ * ownership of partitions with pending elements through a queue of ready
+ * partition ids.
+ * Every partition is a separate ring, so with the default parameters the
+ * queue takes up 1 MiB.
+ */
+template <typename T, std::size_t P = 4, std::size_t O = 12>
+class partitioned_queue_t {
+public:
+  using pointer = T*;
+  /** number of partitions */
+  static constexpr auto PARTITIONS = std::size_t{ 1 } << P;
+private:
+  static_assert(P >= 3, "there must be at least 8 partitions");
+  /** type aliases */
+  using ring_t        = ::scq::cas2::bounded_queue_t<T, O>;
+  using ready_queue_t = detail::ready_queue_t<P>;
+  /** memory ordering constants */
+  static constexpr auto relaxed = std::memory_order_relaxed;
+  static constexpr auto seq_cst = std::memory_order_seq_cst;
+
+
+  /** Maps a key onto a partition using Fibonacci hashing. */
+  static constexpr std::size_t partition_of(std::size_t key) noexcept {
+    return static_cast<std::size_t>((key * std::uint64_t{ 0x9E3779B97F4A7C15 }) >> (64 - P));
+  }
+
+  void schedule(std::size_t partition);
+
+  /** The ids of partitions with pending elements, which remain scheduled while claimed. */
+  ready_queue_t m_ready{ };
+  /** The partitions. */
+  std::array<ring_t, PARTITIONS> m_partitions{ };
+
+public:
+  /** the capacity of each individual partition */
+  static constexpr auto PARTITION_CAPACITY = ring_t::CAPACITY;
+
+  /** constructor */
+  partitioned_queue_t() noexcept = default;
+  ~partitioned_queue_t() = default;
+
+  /**
+   * Attempts to enqueue an element into the partition of the given key.
+   *
+   * Elements with the same key are dequeued in the order they are enqueued
+   * in, as long as they are enqueued by the same thread.
+   *
+   * @param key the element's key, e.g., the result of `std::hash`
+   * @return true upon success, false if the key's partition is full
+   * @throws `std::invalid_argument` exception, if `elem` is `nullptr`
+   */
+  bool try_enqueue(std::size_t key, pointer elem);
+
+  /**
+   * Attempts to claim exclusive ownership of a partition with pending
+   * elements, which must be released again after consuming them.
+   */
+  bool try_claim(std::size_t& partition);
+  /** Attempts to dequeue an element from a claimed partition. */
+  bool try_dequeue(std::size_t partition, pointer& result) noexcept;
+  /** Releases ownership of a claimed partition. */
+  void release(std::size_t partition);
+
+  /**
+   * Claims a partition, passes up to `max` of its elements to `callback` and
+   * releases it again.
+   *
+   * @return the number of consumed elements
+   */
+  template <typename F>
+  std::size_t drain_batch(std::size_t max, F&& callback);
+};
+}
+
+#endif /* SCQ_PARTITIONED_QUEUE_FWD_HPP */
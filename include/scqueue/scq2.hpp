@@ -2,13 +2,14 @@
 #define SCQ2_HPP
 
 #include <atomic>
+#include <algorithm>
 #include <array>
 
 #include "scq2_fwd.hpp"
 
 namespace scq::cas2 {
-template<typename T, std::size_t O, bool finalize>
-bounded_queue_t<T, O, finalize>::bounded_queue_t(pointer first) {
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bounded_queue_t<T, O, finalize, S>::bounded_queue_t(pointer first) {
   if (first == nullptr) {
     throw std::invalid_argument("elem must not be null");
   }
@@ -20,11 +21,212 @@ bounded_queue_t<T, O, finalize>::bounded_queue_t(pointer first) {
   this->reset_threshold(relaxed);
 }
 
-template<typename T, std::size_t O, bool finalize>
-bool bounded_queue_t<T, O, finalize>::try_enqueue(
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::try_enqueue(
     pointer elem,
     bool ignore_empty,
     bool ignore_full
+) {
+  return this->enqueue_impl(elem, ignore_empty, ignore_full, nullptr);
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::try_enqueue(
+    producer_handle_t& handle,
+    pointer elem,
+    bool ignore_empty,
+    bool ignore_full
+) {
+  const auto res = this->enqueue_impl(elem, ignore_empty, ignore_full, &handle);
+  if (res) {
+    handle.stats.succeeded += 1;
+  } else {
+    handle.stats.failed += 1;
+  }
+
+  return res;
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::try_dequeue(
+    pointer& result,
+    bool ignore_empty
+) noexcept {
+  return this->dequeue_impl(result, ignore_empty, nullptr);
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::try_dequeue(
+    consumer_handle_t& handle,
+    pointer& result,
+    bool ignore_empty
+) noexcept {
+  const auto res = this->dequeue_impl(result, ignore_empty, &handle);
+  if (res) {
+    handle.stats.succeeded += 1;
+  } else {
+    handle.stats.failed += 1;
+  }
+
+  return res;
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+template <typename F>
+void bounded_queue_t<T, O, finalize, S>::enqueue_overwrite(pointer elem, F&& on_drop)
+  requires (!finalize)
+{
+  while (!this->try_enqueue(elem)) {
+    // the queue is full, so the oldest element is dequeued and dropped
+    pointer oldest;
+    if (this->try_dequeue(oldest)) {
+      this->m_dropped.fetch_add(1, relaxed);
+      on_drop(oldest);
+    }
+  }
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+void bounded_queue_t<T, O, finalize, S>::enqueue_overwrite(pointer elem)
+  requires (!finalize)
+{
+  this->enqueue_overwrite(elem, [](pointer) {});
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+std::size_t bounded_queue_t<T, O, finalize, S>::dropped_count() const noexcept {
+  return this->m_dropped.load(relaxed);
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+void bounded_queue_t<T, O, finalize, S>::set_watermarks(
+    std::size_t low,
+    std::size_t high,
+    detail::watermark_t::callback_t callback
+) {
+  this->m_watermark.configure(low, high, std::move(callback));
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::above_watermark() const noexcept {
+  return this->m_watermark.above();
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+void bounded_queue_t<T, O, finalize, S>::close() noexcept requires finalize {
+  const auto tail = this->m_tail.fetch_or(finalize_bit_t::bit, acq_rel);
+  if ((tail & finalize_bit_t::bit) == 0) {
+    this->m_closed_tail.store(tail, release);
+    this->m_drain_signal.notify();
+  }
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::closed_and_empty() const noexcept {
+  const auto closed_tail = this->m_closed_tail.load(acquire);
+  if (closed_tail == OPEN_TAIL) {
+    return false;
+  }
+
+  // enqueues in progress have claimed their tail index before the queue was
+  // closed, so the queue is empty once the head has passed all of them
+  return cycle_t{ closed_tail } <= cycle_t{ this->m_head.load(acquire) };
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+template <typename F>
+std::size_t bounded_queue_t<T, O, finalize, S>::try_dequeue_bulk(
+    std::size_t max,
+    F&& callback
+) {
+  if (max == 0 || this->m_threshold.exhausted(acquire)) {
+    return 0;
+  }
+
+  const auto head = this->m_head.load(acquire);
+  const auto tail = this->m_tail.load(acquire) & finalize_bit_t::mask;
+  const auto avail = static_cast<std::intmax_t>(tail - head);
+  if (avail <= 0) {
+    // defer to a regular dequeue, which takes care of the empty detection
+    pointer elem;
+    if (!this->try_dequeue(elem)) {
+      return 0;
+    }
+
+    callback(elem);
+    return 1;
+  }
+
+  // claim all apparently filled indices at once
+  const auto count = std::min(max, static_cast<std::size_t>(avail));
+  const auto first = this->m_head.fetch_add(count, acq_rel);
+
+  std::size_t dequeued = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    pointer elem;
+    if (this->consume_slot(first + i, elem)) {
+      callback(elem);
+      dequeued += 1;
+    } else {
+      (void) this->m_threshold.decrement();
+    }
+  }
+
+  // concurrent dequeues may have pushed the head beyond the tail
+  const auto last = this->m_tail.load(acquire);
+  if (cycle_t{ last & finalize_bit_t::mask } <= cycle_t{ first + count }) {
+    this->catchup(last, first + count);
+  }
+
+  if (dequeued > 0 && this->m_watermark.enabled() && this->m_watermark.above()) {
+    this->m_watermark.after_dequeue(
+        this->approx_size(),
+        [this] { return this->approx_size(); }
+    );
+  }
+
+  return dequeued;
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+template <typename F>
+bool bounded_queue_t<T, O, finalize, S>::drain(F&& callback) {
+  while (this->try_dequeue_bulk(DRAIN_BATCH, callback) > 0);
+  return this->closed_and_empty();
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+template <typename F>
+std::size_t bounded_queue_t<T, O, finalize, S>::drain_until_closed(F&& callback)
+  requires finalize
+{
+  std::size_t drained = 0;
+  while (!this->closed_and_empty()) {
+    auto dequeued = this->try_dequeue_bulk(DRAIN_BATCH, callback);
+    if (dequeued == 0) {
+      // an enqueue or close racing with the check below is guaranteed to
+      // find the registration and wake the drainer
+      const auto epoch = this->m_drain_signal.prepare();
+      dequeued = this->try_dequeue_bulk(DRAIN_BATCH, callback);
+      if (dequeued == 0 && !this->closed_and_empty()) {
+        this->m_drain_signal.park(epoch);
+      } else {
+        this->m_drain_signal.cancel();
+      }
+    }
+
+    drained += dequeued;
+  }
+
+  return drained;
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::enqueue_impl(
+    pointer elem,
+    bool ignore_empty,
+    bool ignore_full,
+    producer_handle_t* handle
 ) {
   if (elem == nullptr) {
     throw std::invalid_argument("`elem` must not be null");
@@ -33,15 +235,22 @@ bool bounded_queue_t<T, O, finalize>::try_enqueue(
   if (!ignore_full) {
     // check if the queue is full
     const auto tail = this->m_tail.load(acquire);
-    if (tail >= this->m_head.load(acquire) + N) {
+    if (this->is_full(tail, handle)) {
       if constexpr (finalize) {
-        this->m_tail.fetch_or(finalize_bit_t::bit, release);
+        this->close();
       }
       return false;
     }
   }
 
   while (true) {
+    if constexpr (finalize) {
+      // avoids incrementing the tail of a closed queue in most cases
+      if ((this->m_tail.load(relaxed) & finalize_bit_t::bit) != 0) [[unlikely]] {
+        return false;
+      }
+    }
+
     // increment tail index
     const auto tail = this->m_tail.fetch_add(1, acq_rel);
     if constexpr (finalize) {
@@ -56,10 +265,7 @@ bool bounded_queue_t<T, O, finalize>::try_enqueue(
     // calculate remapped index for avoiding false sharing
     auto& slot = this->m_array[cache_remap(tail)];
     // read the pair at the (remapped) buffer index
-    auto pair = pair_t{
-        slot.tag.load(relaxed),
-        slot.ptr.load(relaxed)
-    };
+    auto pair = slot.load(acquire);
 
     while (true) {
       // calculate cycle of the read tuple value
@@ -79,8 +285,20 @@ bool bounded_queue_t<T, O, finalize>::try_enqueue(
           continue;
         }
 
-        if (!ignore_empty && this->m_threshold.load(relaxed) != THRESHOLD) {
-          this->reset_threshold(release);
+        if (!ignore_empty) {
+          this->m_threshold.refresh(acquire);
+        }
+
+        if (this->m_watermark.enabled() && !this->m_watermark.above()) {
+          const auto head = this->m_head.load(relaxed);
+          this->m_watermark.after_enqueue(
+              static_cast<std::intmax_t>(tail + 1 - head),
+              [this] { return this->approx_size(); }
+          );
+        }
+
+        if constexpr (finalize) {
+          this->m_drain_signal.notify();
         }
 
         return true;
@@ -88,9 +306,9 @@ bool bounded_queue_t<T, O, finalize>::try_enqueue(
 
       if (!ignore_full) {
         // check again if the queue is full
-        if (tail + 1 >= this->m_head.load(relaxed) + N) {
+        if (this->is_full(tail + 1, handle)) {
           if constexpr (finalize) {
-            this->m_tail.fetch_or(finalize_bit_t::bit, release);
+            this->close();
           }
 
           return false;
@@ -102,70 +320,142 @@ bool bounded_queue_t<T, O, finalize>::try_enqueue(
   }
 }
 
-template<typename T, std::size_t O, bool finalize>
-bool bounded_queue_t<T, O, finalize>::try_dequeue(
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::dequeue_impl(
     pointer& result,
-    bool ignore_empty
+    bool ignore_empty,
+    consumer_handle_t* handle
 ) noexcept {
-  if (!ignore_empty && this->m_threshold.load(acquire) < 0) {
+  if (!ignore_empty && this->m_threshold.exhausted(acquire)) {
     return false;
   }
 
   while (true) {
     const auto head = this->m_head.fetch_add(1, acq_rel);
-    const auto head_cycle = cycle_t{ head & ~(N - 1) };
-
-    auto& slot = this->m_array[cache_remap(head)];
-    auto tag = slot.tag.load(acquire);
+    if (this->consume_slot(head, result)) {
+      if (this->m_watermark.enabled() && this->m_watermark.above()) {
+        const auto tail = this->m_tail.load(relaxed) & finalize_bit_t::mask;
+        this->m_watermark.after_dequeue(
+            static_cast<std::intmax_t>(tail - (head + 1)),
+            [this] { return this->approx_size(); }
+        );
+      }
 
-    cycle_t tag_cycle;
-    std::uintmax_t tag_new;
+      return true;
+    }
 
-    do {
-      tag_cycle = cycle_t{ tag & ~(N - 1) };
-      if (tag_cycle.val == head_cycle.val) {
-        auto pair = slot.fetch_and(pair_t{ ~ENQUEUE_BIT, nullptr }, acq_rel);
-        result = pair.ptr;
-        return true;
-      }
+    if (!ignore_empty) {
+      // the tail never decreases, so a cached tail beyond the head proves the
+      // queue is not empty without loading the shared tail
+      if (handle == nullptr || cycle_t{ handle->tail } <= cycle_t{ head + 1 }) {
+        const auto tail = this->m_tail.load(acquire);
+        if (handle != nullptr) {
+          handle->tail = tail & finalize_bit_t::mask;
+          handle->stats.reloads += 1;
+        }
 
-      if ((tag & ~DEQUEUE_BIT) != tag_cycle.val) {
-        tag_new = tag | DEQUEUE_BIT;
-        if (tag == tag_new) {
-          break;
+        if (cycle_t{ tail & finalize_bit_t::mask } <= cycle_t{ head + 1 }) {
+          this->catchup(tail, head + 1);
+          (void) this->m_threshold.decrement();
+          return false;
         }
-      } else {
-        tag_new = head_cycle.val | (tag & DEQUEUE_BIT);
       }
-    } while (
-        tag_cycle < head_cycle
-        && !slot.tag.compare_exchange_weak(tag, tag_new, acq_rel, acquire)
-    );
 
-    if (!ignore_empty) {
-      const auto tail = this->m_tail.load(acquire);
-      if (cycle_t{ tail & finalize_bit_t::mask } <= cycle_t{ head + 1 }) {
-        this->catchup(tail, head + 1);
-        this->m_threshold.fetch_sub(1, acq_rel);
+      if (this->m_threshold.decrement()) {
         return false;
       }
+    }
+  }
+}
 
-      if (this->m_threshold.fetch_sub(1, acq_rel) <= 0) {
-        return false;
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::consume_slot(
+    std::uintmax_t head,
+    pointer& result
+) noexcept {
+  const auto head_cycle = cycle_t{ head & ~(N - 1) };
+
+  auto& slot = this->m_array[cache_remap(head)];
+  auto tag = slot.load_tag(acquire);
+
+  cycle_t tag_cycle;
+  std::uintmax_t tag_new;
+
+  do {
+    tag_cycle = cycle_t{ tag & ~(N - 1) };
+    if (tag_cycle.val == head_cycle.val) {
+      // while the enqueue bit is set, no other thread can replace the
+      // pointer, so it can be read separately and the slot released with a
+      // single-word fetch-and instead of a double-width CAS loop
+      result = slot.load_ptr(relaxed);
+      slot.fetch_and_tag(~ENQUEUE_BIT, acq_rel);
+      return true;
+    }
+
+    if ((tag & ~DEQUEUE_BIT) != tag_cycle.val) {
+      tag_new = tag | DEQUEUE_BIT;
+      if (tag == tag_new) {
+        break;
       }
+    } else {
+      tag_new = head_cycle.val | (tag & DEQUEUE_BIT);
+    }
+  } while (
+      tag_cycle < head_cycle
+      && !slot.compare_exchange_tag_weak(tag, tag_new, acq_rel, acquire)
+  );
+
+  return false;
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+bool bounded_queue_t<T, O, finalize, S>::is_full(
+    std::uintmax_t tail,
+    producer_handle_t* handle
+) noexcept {
+  // the head never decreases, so a cached head is a lower bound and can prove
+  // that the queue is not full without loading the shared head
+  if (handle != nullptr) {
+    if (tail < handle->head + N) {
+      return false;
     }
+
+    handle->stats.reloads += 1;
   }
+
+  const auto head = this->m_head.load(acquire);
+  if (handle != nullptr) {
+    handle->head = head;
+  }
+
+  return tail >= head + N;
+}
+
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+std::intmax_t bounded_queue_t<T, O, finalize, S>::approx_size() const noexcept {
+  const auto head = this->m_head.load(relaxed);
+  auto tail = this->m_tail.load(relaxed) & finalize_bit_t::mask;
+  if constexpr (finalize) {
+    const auto closed_tail = this->m_closed_tail.load(relaxed);
+    if (closed_tail != OPEN_TAIL) {
+      // failed dequeues may have moved the head beyond the closed tail
+      tail = cycle_t{ closed_tail } < cycle_t{ tail } ? closed_tail : tail;
+      return cycle_t{ tail } <= cycle_t{ head } ? 0 : static_cast<std::intmax_t>(tail - head);
+    }
+  }
+
+  return static_cast<std::intmax_t>(tail - head);
 }
 
-template<typename T, std::size_t O, bool finalize>
-void bounded_queue_t<T, O, finalize>::reset_threshold(
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+void bounded_queue_t<T, O, finalize, S>::reset_threshold(
     std::memory_order order
 ) noexcept {
-  this->m_threshold.store(THRESHOLD, order);
+  this->m_threshold.reset(order);
 }
 
-template<typename T, std::size_t O, bool finalize>
-void bounded_queue_t<T, O, finalize>::catchup(
+template<typename T, std::size_t O, bool finalize, std::size_t S>
+void bounded_queue_t<T, O, finalize, S>::catchup(
     std::uintmax_t tail,
     std::uintmax_t head
 ) noexcept {
@@ -3,23 +3,32 @@
 
 #include <atomic>
 #include <array>
+#include <limits>
 
 #include "scqueue/detail/detail.hpp"
 
 namespace scq::cas2 {
-template <typename T, std::size_t O = 16, bool finalize = false>
+/**
+ * A bounded queue of pointers using double-width CAS.
+ *
+ * @tparam S the number of stripes of the empty-detection threshold, see
+ *   `scq::detail::threshold_t`
+ */
+template <typename T, std::size_t O = 16, bool finalize = false, std::size_t S = 1>
 class bounded_queue_t {
   /** size and bit constants */
   static constexpr auto N           = std::size_t{ 1 } << O;
   static constexpr auto ENQUEUE_BIT = std::uintmax_t{ 0b01 };
   static constexpr auto DEQUEUE_BIT = std::uintmax_t{ 0b10 };
   static constexpr auto THRESHOLD   = 2 * std::intmax_t{ N } - 1;
+  static constexpr auto OPEN_TAIL   = std::numeric_limits<std::uintmax_t>::max();
   /** type aliases */
   using atomic_pair_t  = detail::atomic_pair_t<T>;
   using cycle_t        = detail::cycle_t;
   using finalize_bit_t = scq::detail::finalize_bit_t<finalize>;
   using pair_t         = detail::pair_t<T>;
   using pair_array_t   = std::array<atomic_pair_t, N>;
+  using threshold_t    = detail::threshold_t<THRESHOLD, S>;
   /** memory ordering constants */
   static constexpr auto relaxed = std::memory_order_relaxed;
   static constexpr auto acquire = std::memory_order_acquire;
@@ -35,14 +44,46 @@ class bounded_queue_t {
 
   alignas(128) std::atomic_uintmax_t m_head{ N };
   alignas(128) std::atomic_uintmax_t m_tail{ N };
-  alignas(128) std::atomic_intmax_t  m_threshold{ -1 };
+  /** The tail at the time the queue was closed, rejected enqueues still increment `m_tail`. */
+  std::atomic_uintmax_t              m_closed_tail{ OPEN_TAIL };
+  alignas(128) threshold_t           m_threshold{ -1 };
   alignas(128) pair_array_t          m_array{ };
+  alignas(128) std::atomic_size_t    m_dropped{ 0 };
+  alignas(128) detail::watermark_t   m_watermark{ };
+  /** Parks the consumers in `drain_until_closed`. */
+  detail::drain_signal_t             m_drain_signal{ };
 
 public:
   /** queue capacity */
   static constexpr auto CAPACITY = N;
   using pointer = T*;
 
+  /**
+   * Per-thread producer state, which must neither be shared between threads
+   * nor used with more than one queue.
+   *
+   * Caches a lower bound of the queue's head index, so the full check only
+   * has to load the shared head when the cached value can not rule out a full
+   * queue.
+   */
+  struct producer_handle_t {
+    std::uintmax_t         head{ 0 };
+    detail::handle_stats_t stats{ };
+  };
+
+  /**
+   * Per-thread consumer state, which must neither be shared between threads
+   * nor used with more than one queue.
+   *
+   * Caches a lower bound of the queue's tail index, so the empty check after
+   * a missed slot only has to load the shared tail when the cached value can
+   * not rule out an empty queue.
+   */
+  struct consumer_handle_t {
+    std::uintmax_t         tail{ 0 };
+    detail::handle_stats_t stats{ };
+  };
+
   /** constructor */
   bounded_queue_t() noexcept = default;
   explicit bounded_queue_t(pointer first);
@@ -82,8 +123,112 @@ public:
    */
   bool try_dequeue(pointer& result, bool ignore_empty = false) noexcept;
 
+  /** Attempts to enqueue an element using the calling thread's `handle`. */
+  bool try_enqueue(
+      producer_handle_t& handle,
+      pointer elem,
+      bool ignore_empty = false,
+      bool ignore_full = false
+  );
+
+  /** Attempts to dequeue an element using the calling thread's `handle`. */
+  bool try_dequeue(
+      consumer_handle_t& handle,
+      pointer& result,
+      bool ignore_empty = false
+  ) noexcept;
+
+  /**
+   * Enqueues an element, discarding the oldest elements for as long as the
+   * queue is full, so producers never have to wait for consumers.
+   *
+   * @param elem the element to be enqueued, must not be null
+   * @param on_drop invoked with every discarded element
+   *
+   * @throws `std::invalid_argument` exception, if `elem` is `nullptr`
+   */
+  template <typename F>
+  void enqueue_overwrite(pointer elem, F&& on_drop) requires (!finalize);
+  /** Enqueues an element, discarding the oldest elements while the queue is full. */
+  void enqueue_overwrite(pointer elem) requires (!finalize);
+  /** Returns the number of elements discarded by overwriting enqueues. */
+  [[nodiscard]] std::size_t dropped_count() const noexcept;
+
+  /**
+   * Configures high and low watermarks for the queue's occupancy, which must
+   * be done before the queue is shared between threads.
+   *
+   * Once an enqueue brings the occupancy to at least `high`, the watermark
+   * state flips and `callback` is invoked with true, once a dequeue brings it
+   * to at most `low`, it flips back and `callback` is invoked with false.
+   * The callback is never invoked concurrently and always with alternating
+   * states, but crossings undone before they are reported are skipped.
+   * The callback must not throw.
+   *
+   * @throws `std::invalid_argument` exception, if `low` is not less than `high`
+   */
+  void set_watermarks(
+      std::size_t low,
+      std::size_t high,
+      detail::watermark_t::callback_t callback = {}
+  );
+  /** Returns true if the high watermark has been crossed but not yet the low one. */
+  [[nodiscard]] bool above_watermark() const noexcept;
+
+  /** Returns the number of enqueued elements, which may be stale under contention. */
+  [[nodiscard]] std::intmax_t approx_size() const noexcept;
+
+  /** the maximum number of elements dequeued per batch by `drain` and `drain_until_closed` */
+  static constexpr auto DRAIN_BATCH = std::size_t{ 64 };
+
+  /** Closes the queue, so that all further enqueue attempts fail. */
+  void close() noexcept requires finalize;
+  /** Returns true if the queue is closed and all its elements have been dequeued. */
+  [[nodiscard]] bool closed_and_empty() const noexcept;
+  /**
+   * Attempts to dequeue up to `max` elements by advancing the head index for
+   * all of them at once and passes each of them to `callback`.
+   *
+   * @return the number of dequeued elements
+   */
+  template <typename F>
+  std::size_t try_dequeue_bulk(std::size_t max, F&& callback);
+  /**
+   * Dequeues the currently available elements in batches and passes each of
+   * them to `callback`, returning as soon as a batch comes back empty, even
+   * if the queue is still open.
+   *
+   * @return true if the queue is closed and no elements are left, i.e., no
+   *   further elements will ever become available
+   */
+  template <typename F>
+  bool drain(F&& callback);
+  /**
+   * Dequeues elements in batches and passes each of them to `callback`,
+   * blocking while the queue is empty, until it is closed and empty.
+   *
+   * @return the number of dequeued elements
+   */
+  template <typename F>
+  std::size_t drain_until_closed(F&& callback) requires finalize;
+
   /** Resets the threshold. */
   void reset_threshold(std::memory_order order) noexcept;
+
+private:
+  bool consume_slot(std::uintmax_t head, pointer& result) noexcept;
+  bool is_full(std::uintmax_t tail, producer_handle_t* handle) noexcept;
+  bool enqueue_impl(
+      pointer elem,
+      bool ignore_empty,
+      bool ignore_full,
+      producer_handle_t* handle
+  );
+  bool dequeue_impl(
+      pointer& result,
+      bool ignore_empty,
+      consumer_handle_t* handle
+  ) noexcept;
 };
 }
 
@@ -4,14 +4,18 @@
 #include "scqueue/scqd_fwd.hpp"
 #include "scqueue/detail/scq1.hpp"
 
+#include <memory>
+#include <thread>
+#include <utility>
+
 namespace scq::d {
-template <typename T, std::size_t O, bool finalize>
-bounded_queue_t<T, O, finalize>::bounded_queue_t() noexcept :
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bounded_queue_t<T, O, finalize, W, S>::bounded_queue_t() noexcept :
   m_aq{ index_queue_t<finalize>::EMPTY },
   m_fq{ index_queue_t<false>::FILLED } {}
 
-template <typename T, std::size_t O, bool finalize>
-bounded_queue_t<T, O, finalize>::bounded_queue_t(pointer first) :
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bounded_queue_t<T, O, finalize, W, S>::bounded_queue_t(pointer first) :
   m_aq{{ 0, 1 }}, m_fq{{ 1, CAPACITY }}
 {
   if (first == nullptr) [[unlikely]] {
@@ -21,12 +25,12 @@ bounded_queue_t<T, O, finalize>::bounded_queue_t(pointer first) :
   this->m_slots[0] = first;
 }
 
-template <typename T, std::size_t O, bool finalize>
-bool bounded_queue_t<T, O, finalize>::try_enqueue(pointer elem, bool ignore_empty) {
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_queue_t<T, O, finalize, W, S>::try_enqueue(pointer elem, bool ignore_empty) {
   std::size_t enqueue_idx;
-  if (!this->m_fq.try_dequeue(enqueue_idx, ignore_empty)) {
+  if (!this->try_free_index(enqueue_idx, ignore_empty)) {
     if constexpr (finalize) {
-      this->m_aq.finalize_queue();
+      this->close();
     }
 
     return false;
@@ -40,13 +44,22 @@ bool bounded_queue_t<T, O, finalize>::try_enqueue(pointer elem, bool ignore_empt
       (void) this->m_fq.try_enqueue(enqueue_idx);
       return false;
     }
+
+    this->m_drain_signal.notify();
+  }
+
+  if (this->m_watermark.enabled() && !this->m_watermark.above()) {
+    this->m_watermark.after_enqueue(
+        this->m_aq.approx_size(),
+        [this] { return this->m_aq.approx_size(); }
+    );
   }
 
   return true;
 }
 
-template <typename T, std::size_t O, bool finalize>
-bool bounded_queue_t<T, O, finalize>::try_dequeue(pointer& result, bool ignore_empty) {
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_queue_t<T, O, finalize, W, S>::try_dequeue(pointer& result, bool ignore_empty) {
   std::uintmax_t dequeue_idx;
   if (!this->m_aq.try_dequeue(dequeue_idx)) {
     return false;
@@ -55,13 +68,360 @@ bool bounded_queue_t<T, O, finalize>::try_dequeue(pointer& result, bool ignore_e
   result = this->m_slots[dequeue_idx];
 
   (void) this->m_fq.try_enqueue(dequeue_idx, ignore_empty);
+
+  if (this->m_watermark.enabled() && this->m_watermark.above()) {
+    this->m_watermark.after_dequeue(
+        this->m_aq.approx_size(),
+        [this] { return this->m_aq.approx_size(); }
+    );
+  }
+
+  return true;
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_queue_t<T, O, finalize, W, S>::try_enqueue(
+    magazine_t& magazine,
+    pointer elem,
+    bool ignore_empty
+) requires (!finalize) {
+  std::size_t enqueue_idx;
+  if (magazine.m_count > 0) {
+    enqueue_idx = magazine.m_indices[--magazine.m_count];
+  } else if (!this->try_free_index(enqueue_idx, ignore_empty)) {
+    return false;
+  }
+
+  this->m_slots[enqueue_idx] = elem;
+  (void) this->m_aq.try_enqueue(enqueue_idx);
+
+  if (this->m_watermark.enabled() && !this->m_watermark.above()) {
+    this->m_watermark.after_enqueue(
+        this->m_aq.approx_size(),
+        [this] { return this->m_aq.approx_size(); }
+    );
+  }
+
+  return true;
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_queue_t<T, O, finalize, W, S>::try_dequeue(
+    magazine_t& magazine,
+    pointer& result,
+    bool ignore_empty
+) requires (!finalize) {
+  std::size_t dequeue_idx;
+  const auto dequeued = this->m_aq.try_dequeue(dequeue_idx);
+  if (dequeued) {
+    result = this->m_slots[dequeue_idx];
+
+    if (magazine.m_count < magazine.m_quota || this->refill(magazine)) {
+      magazine.m_indices[magazine.m_count++] = dequeue_idx;
+    } else {
+      // the magazine is full or magazines cache as many indices as they may
+      (void) this->m_fq.try_enqueue(dequeue_idx, ignore_empty);
+    }
+  }
+
+  // failed dequeues must return cached indices as well, since the queue may
+  // only appear empty because all free indices are cached
+  if (magazine.m_count > 0 && this->m_starved.load(std::memory_order_relaxed)) {
+    this->flush(magazine, magazine.m_count, ignore_empty);
+  }
+
+  if (!dequeued) {
+    return false;
+  }
+
+  if (this->m_watermark.enabled() && this->m_watermark.above()) {
+    this->m_watermark.after_dequeue(
+        this->m_aq.approx_size(),
+        [this] { return this->m_aq.approx_size(); }
+    );
+  }
+
+  return true;
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_queue_t<T, O, finalize, W, S>::try_free_index(std::size_t& idx, bool ignore_empty) {
+  if (this->m_fq.try_dequeue(idx, ignore_empty)) {
+    if constexpr (!finalize) {
+      if (this->m_magazines.load(std::memory_order_relaxed)) {
+        this->set_starved(false);
+      }
+    }
+
+    return true;
+  }
+
+  if constexpr (!finalize) {
+    if (!this->m_magazines.load(std::memory_order_relaxed)) {
+      return false;
+    }
+
+    // cached indices count as free, so the queue is only reported full once
+    // consumers stop returning them, which only idle consumers do
+    auto cached = this->m_cached.load(std::memory_order_acquire);
+    while (cached > 0) {
+      this->set_starved(true);
+      std::this_thread::yield();
+      if (this->m_fq.try_dequeue(idx, ignore_empty)) {
+        return true;
+      }
+
+      const auto prev = std::exchange(cached, this->m_cached.load(std::memory_order_acquire));
+      if (cached >= prev) {
+        break;
+      }
+    }
+  }
+
+  return false;
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_queue_t<T, O, finalize, W, S>::set_starved(bool starved) noexcept {
+  if (this->m_starved.load(std::memory_order_relaxed) != starved) {
+    this->m_starved.store(starved, std::memory_order_relaxed);
+  }
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_queue_t<T, O, finalize, W, S>::flush(
+    magazine_t& magazine,
+    std::size_t count,
+    bool ignore_empty
+) {
+  for (std::size_t i = 0; i < count; ++i) {
+    (void) this->m_fq.try_enqueue(magazine.m_indices[--magazine.m_count], ignore_empty);
+  }
+
+  // room reserved for indices reused by the magazine's own enqueues is
+  // released as well
+  const auto released = magazine.m_quota - magazine.m_count;
+  if (released > 0) {
+    magazine.m_quota = magazine.m_count;
+    this->m_cached.fetch_sub(released, std::memory_order_release);
+  }
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_queue_t<T, O, finalize, W, S>::refill(magazine_t& magazine) noexcept {
+  if (magazine.m_quota + MAGAZINE_BATCH > MAGAZINE_SIZE) {
+    return false;
+  }
+
+  auto cached = this->m_cached.load(std::memory_order_relaxed);
+  do {
+    if (cached + MAGAZINE_BATCH > CACHE_LIMIT) {
+      return false;
+    }
+  } while (!this->m_cached.compare_exchange_weak(
+      cached,
+      cached + MAGAZINE_BATCH,
+      std::memory_order_relaxed,
+      std::memory_order_relaxed
+  ));
+
+  magazine.m_quota += MAGAZINE_BATCH;
   return true;
 }
 
-template <typename T, std::size_t O, bool finalize>
-void bounded_queue_t<T, O, finalize>::reset_threshold(std::memory_order order) {
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+template <typename F>
+void bounded_queue_t<T, O, finalize, W, S>::enqueue_overwrite(pointer elem, F&& on_drop)
+  requires (!finalize)
+{
+  while (!this->try_enqueue(elem)) {
+    // no free index is left, so the oldest element is dequeued and dropped,
+    // which returns its index to the free queue
+    pointer oldest;
+    if (this->try_dequeue(oldest)) {
+      this->m_dropped.fetch_add(1, std::memory_order_relaxed);
+      on_drop(oldest);
+    }
+  }
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_queue_t<T, O, finalize, W, S>::enqueue_overwrite(pointer elem)
+  requires (!finalize)
+{
+  this->enqueue_overwrite(elem, [](pointer) {});
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+std::size_t bounded_queue_t<T, O, finalize, W, S>::dropped_count() const noexcept {
+  return this->m_dropped.load(std::memory_order_relaxed);
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_queue_t<T, O, finalize, W, S>::set_watermarks(
+    std::size_t low,
+    std::size_t high,
+    detail::watermark_t::callback_t callback
+) {
+  this->m_watermark.configure(low, high, std::move(callback));
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_queue_t<T, O, finalize, W, S>::above_watermark() const noexcept {
+  return this->m_watermark.above();
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+std::intmax_t bounded_queue_t<T, O, finalize, W, S>::approx_size() const noexcept {
+  return this->m_aq.approx_size();
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_queue_t<T, O, finalize, W, S>::close() noexcept requires finalize {
+  this->m_aq.finalize_queue();
+  this->m_drain_signal.notify();
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_queue_t<T, O, finalize, W, S>::closed_and_empty() const noexcept {
+  return this->m_aq.closed_and_empty();
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+template <typename F>
+std::size_t bounded_queue_t<T, O, finalize, W, S>::try_dequeue_bulk(
+    std::size_t max,
+    F&& callback
+) {
+  const auto dequeued = this->m_aq.try_dequeue_bulk(max, [&](std::size_t idx) {
+    const auto elem = this->m_slots[idx];
+    (void) this->m_fq.try_enqueue(idx);
+    callback(elem);
+  });
+
+  if (dequeued > 0 && this->m_watermark.enabled() && this->m_watermark.above()) {
+    this->m_watermark.after_dequeue(
+        this->m_aq.approx_size(),
+        [this] { return this->m_aq.approx_size(); }
+    );
+  }
+
+  return dequeued;
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+template <typename F>
+bool bounded_queue_t<T, O, finalize, W, S>::drain(F&& callback) {
+  while (this->try_dequeue_bulk(DRAIN_BATCH, callback) > 0);
+  return this->closed_and_empty();
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+template <typename F>
+std::size_t bounded_queue_t<T, O, finalize, W, S>::drain_until_closed(F&& callback)
+  requires finalize
+{
+  std::size_t drained = 0;
+  while (!this->closed_and_empty()) {
+    auto dequeued = this->try_dequeue_bulk(DRAIN_BATCH, callback);
+    if (dequeued == 0) {
+      // an enqueue or close racing with the check below is guaranteed to
+      // find the registration and wake the drainer
+      const auto epoch = this->m_drain_signal.prepare();
+      dequeued = this->try_dequeue_bulk(DRAIN_BATCH, callback);
+      if (dequeued == 0 && !this->closed_and_empty()) {
+        this->m_drain_signal.park(epoch);
+      } else {
+        this->m_drain_signal.cancel();
+      }
+    }
+
+    drained += dequeued;
+  }
+
+  return drained;
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_queue_t<T, O, finalize, W, S>::reset_threshold(std::memory_order order) {
   this->m_aq.reset_threshold(order);
 }
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bounded_slot_queue_t<T, O, finalize, W, S>::bounded_slot_queue_t() noexcept :
+  m_aq{ index_queue_t<finalize>::EMPTY },
+  m_fq{ index_queue_t<false>::FILLED } {}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bounded_slot_queue_t<T, O, finalize, W, S>::~bounded_slot_queue_t() {
+  std::size_t idx;
+  while (this->m_aq.try_dequeue(idx)) {
+    std::destroy_at(this->payload(idx));
+  }
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+T* bounded_slot_queue_t<T, O, finalize, W, S>::payload(std::size_t idx) noexcept {
+  return std::launder(reinterpret_cast<T*>(this->m_slots[idx].bytes));
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_slot_queue_t<T, O, finalize, W, S>::try_reserve(slot_ref_t& slot, bool ignore_empty) {
+  std::size_t idx;
+  if (!this->m_fq.try_dequeue(idx, ignore_empty)) {
+    if constexpr (finalize) {
+      this->m_aq.finalize_queue();
+    }
+
+    return false;
+  }
+
+  slot.m_idx = idx;
+  slot.m_payload = reinterpret_cast<T*>(this->m_slots[idx].bytes);
+  slot.m_constructed = false;
+  return true;
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_slot_queue_t<T, O, finalize, W, S>::commit(slot_ref_t slot) {
+  const auto res = this->m_aq.try_enqueue(slot.m_idx);
+  if constexpr (finalize) {
+    if (!res) {
+      this->cancel(slot);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_slot_queue_t<T, O, finalize, W, S>::cancel(slot_ref_t slot) {
+  if (slot.m_constructed) {
+    std::destroy_at(slot.m_payload);
+  }
+
+  (void) this->m_fq.try_enqueue(slot.m_idx);
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+bool bounded_slot_queue_t<T, O, finalize, W, S>::try_peek(slot_ref_t& slot) {
+  std::size_t idx;
+  if (!this->m_aq.try_dequeue(idx)) {
+    return false;
+  }
+
+  slot.m_idx = idx;
+  slot.m_payload = this->payload(idx);
+  slot.m_constructed = true;
+  return true;
+}
+
+template <typename T, std::size_t O, bool finalize, typename W, std::size_t S>
+void bounded_slot_queue_t<T, O, finalize, W, S>::release(slot_ref_t slot) {
+  std::destroy_at(slot.m_payload);
+  (void) this->m_fq.try_enqueue(slot.m_idx);
+}
 }
 
 #endif /* SCQD_HPP */
@@ -1,21 +1,38 @@
 #ifndef SCQD_FWD_HPP
 #define SCQD_FWD_HPP
 
+#include <algorithm>
 #include <atomic>
 #include <array>
+#include <cstddef>
+#include <new>
+#include <utility>
 
 #include "scqueue/detail/detail.hpp"
 #include <scqueue/detail/scq1_fwd.hpp>
 
 namespace scq::d {
-template <typename T, std::size_t O = 16, bool finalize = false>
+/**
+ * A queue of pointers, built from a pair of index queues.
+ *
+ * @tparam W the slot word type of both index queues, see
+ *   `scq::cas1::bounded_index_queue_t`
+ * @tparam S the number of threshold stripes of both index queues
+ */
+template <
+    typename T,
+    std::size_t O = 16,
+    bool finalize = false,
+    typename W = std::uintmax_t,
+    std::size_t S = 1
+>
 class bounded_queue_t {
 public:
   using pointer = T*;
   static constexpr auto CAPACITY = std::size_t{ 1 } << O;
 private:
   template <bool _finalize>
-  using index_queue_t = ::scq::cas1::bounded_index_queue_t<O, _finalize>;
+  using index_queue_t = ::scq::cas1::bounded_index_queue_t<O, _finalize, W, S>;
   using slot_array_t  = std::array<pointer, CAPACITY>;
   /** The queue for storing the indices of enqueued pointers. */
   index_queue_t<finalize> m_aq;
@@ -23,8 +40,65 @@ private:
   slot_array_t  m_slots{};
   /** The queue for storing all available indices. */
   index_queue_t<false> m_fq;
+  /** The number of elements discarded by overwriting enqueues. */
+  alignas(128) std::atomic_size_t m_dropped{ 0 };
+  /** The occupancy watermarks. */
+  alignas(128) detail::watermark_t m_watermark{ };
+  /** Set once the first magazine is created, queues without magazines skip their bookkeeping. */
+  alignas(128) std::atomic_bool m_magazines{ false };
+  /** Set while producers find no free indices, asking consumers to flush their magazines. */
+  alignas(128) std::atomic_bool m_starved{ false };
+  /** The number of indices reserved by all magazines, updated in batches. */
+  std::atomic_size_t m_cached{ 0 };
+  /** Parks the consumers in `drain_until_closed`. */
+  detail::drain_signal_t m_drain_signal{ };
 
 public:
+  /** the maximum number of indices cached by a magazine */
+  static constexpr auto MAGAZINE_SIZE  = std::size_t{ 32 };
+  /** the maximum number of indices cached by all magazines together */
+  static constexpr auto CACHE_LIMIT    = CAPACITY / 2;
+  /** the number of indices a magazine reserves for caching at once */
+  static constexpr auto MAGAZINE_BATCH =
+      std::max(std::min(MAGAZINE_SIZE, CACHE_LIMIT) / 4, std::size_t{ 1 });
+
+  /**
+   * A per-thread cache of free indices, which must neither be shared between
+   * threads nor used with any other queue than the one it is created for.
+   *
+   * Indices freed by dequeues are cached and reused by the same thread's
+   * enqueues, so that they bypass the shared free index queue.
+   * Magazines reserve room for caching in batches of `MAGAZINE_BATCH`
+   * indices and together never cache more than `CACHE_LIMIT`, so the queue
+   * can only appear full while it holds at least `CAPACITY - CACHE_LIMIT`
+   * elements, even if consumers are idle; freed indices without reserved
+   * room are returned to the queue directly.
+   * Cached indices are returned to the queue with the next dequeue attempt
+   * (successful or not) after a producer found no free index in the queue,
+   * which keeps retrying for as long as consumers return indices, or once
+   * the magazine is destroyed, so they are never lost.
+   * A thread that stops dequeuing should destroy its magazine, since it can
+   * not return its cached indices otherwise.
+   */
+  class magazine_t {
+    friend class bounded_queue_t;
+
+    bounded_queue_t&                           m_queue;
+    std::size_t                                m_count{ 0 };
+    std::size_t                                m_quota{ 0 };
+    std::array<std::size_t, MAGAZINE_SIZE>     m_indices{ };
+
+  public:
+    explicit magazine_t(bounded_queue_t& queue) noexcept : m_queue{ queue } {
+      if (!queue.m_magazines.load(std::memory_order_relaxed)) {
+        queue.m_magazines.store(true, std::memory_order_relaxed);
+      }
+    }
+    magazine_t(const magazine_t&) = delete;
+    magazine_t& operator=(const magazine_t&) = delete;
+    ~magazine_t() { this->m_queue.flush(*this, this->m_count, false); }
+  };
+
   /** constructors */
   bounded_queue_t() noexcept;
   explicit bounded_queue_t(pointer first);
@@ -35,7 +109,175 @@ public:
   bool try_enqueue(pointer elem, bool ignore_empty = false);
   /** Attempts to dequeue an element from the start of the queue. */
   bool try_dequeue(pointer& result, bool ignore_empty = false);
+  /**
+   * Attempts to enqueue an element, preferring free indices from the
+   * calling thread's magazine.
+   *
+   * Fails if neither the magazine nor the queue have a free index, even if
+   * other threads' magazines do, which return them with their next dequeue.
+   */
+  bool try_enqueue(magazine_t& magazine, pointer elem, bool ignore_empty = false)
+    requires (!finalize);
+  /** Attempts to dequeue an element, caching its freed index in the calling thread's magazine. */
+  bool try_dequeue(magazine_t& magazine, pointer& result, bool ignore_empty = false)
+    requires (!finalize);
+  /**
+   * Enqueues an element, discarding the oldest elements for as long as the
+   * queue is full and passing each of them to `on_drop`.
+   */
+  template <typename F>
+  void enqueue_overwrite(pointer elem, F&& on_drop) requires (!finalize);
+  /** Enqueues an element, discarding the oldest elements while the queue is full. */
+  void enqueue_overwrite(pointer elem) requires (!finalize);
+  /** Returns the number of elements discarded by overwriting enqueues. */
+  [[nodiscard]] std::size_t dropped_count() const noexcept;
+  /**
+   * Configures high and low watermarks for the queue's occupancy, see
+   * `scq::cas2::bounded_queue_t::set_watermarks`.
+   */
+  void set_watermarks(
+      std::size_t low,
+      std::size_t high,
+      detail::watermark_t::callback_t callback = {}
+  );
+  /** Returns true if the high watermark has been crossed but not yet the low one. */
+  [[nodiscard]] bool above_watermark() const noexcept;
+  /** Returns the number of enqueued elements, which may be stale under contention. */
+  [[nodiscard]] std::intmax_t approx_size() const noexcept;
+
+  /** the maximum number of elements dequeued per batch by `drain` and `drain_until_closed` */
+  static constexpr auto DRAIN_BATCH = std::size_t{ 64 };
+
+  /** Closes the queue, so that all further enqueue attempts fail. */
+  void close() noexcept requires finalize;
+  /** Returns true if the queue is closed and all its elements have been dequeued. */
+  [[nodiscard]] bool closed_and_empty() const noexcept;
+  /**
+   * Attempts to dequeue up to `max` elements and passes each of them to
+   * `callback`, see `scq::cas2::bounded_queue_t::try_dequeue_bulk`.
+   */
+  template <typename F>
+  std::size_t try_dequeue_bulk(std::size_t max, F&& callback);
+  /**
+   * Dequeues the currently available elements in batches and passes each of
+   * them to `callback`, see `scq::cas2::bounded_queue_t::drain`.
+   *
+   * @return true if the queue is closed and no elements are left
+   */
+  template <typename F>
+  bool drain(F&& callback);
+  /**
+   * Dequeues elements until the queue is closed and empty, see
+   * `scq::cas2::bounded_queue_t::drain_until_closed`.
+   */
+  template <typename F>
+  std::size_t drain_until_closed(F&& callback) requires finalize;
+
   void reset_threshold(std::memory_order order);
+
+private:
+  /**
+   * Attempts to dequeue a free index, retrying while magazines return cached
+   * indices after being asked to.
+   */
+  bool try_free_index(std::size_t& idx, bool ignore_empty);
+  /**
+   * Sets or clears the flag asking consumers to flush their magazines, free
+   * indices may still be cached while the free queue is empty.
+   */
+  void set_starved(bool starved) noexcept;
+  /** Reserves room for another batch of cached indices, unless the limit is reached. */
+  bool refill(magazine_t& magazine) noexcept;
+  /**
+   * Returns the `count` most recently cached indices of `magazine` to the
+   * free queue and releases the room reserved for them.
+   */
+  void flush(magazine_t& magazine, std::size_t count, bool ignore_empty);
+};
+
+/**
+ * A queue owning a fixed-size payload slot of type `T` for every element,
+ * which allows producers to construct elements in place and consumers to
+ * read them in place instead of passing pointers to separate storage.
+ *
+ * The slots are raw storage, so `T` need not be default-constructible:
+ * payloads are constructed by `slot_ref_t::emplace` and destroyed once they
+ * are released or cancelled, or by the queue's destructor.
+ */
+template <
+    typename T,
+    std::size_t O = 16,
+    bool finalize = false,
+    typename W = std::uintmax_t,
+    std::size_t S = 1
+>
+class bounded_slot_queue_t {
+public:
+  static constexpr auto CAPACITY = std::size_t{ 1 } << O;
+
+  /** A reference to a reserved or peeked payload slot. */
+  class slot_ref_t {
+    friend class bounded_slot_queue_t;
+
+    std::size_t m_idx{ 0 };
+    T*          m_payload{ nullptr };
+    bool        m_constructed{ false };
+
+  public:
+    [[nodiscard]] std::size_t idx() const noexcept { return this->m_idx; }
+    /** Constructs the payload of a reserved slot, which must be done once before committing it. */
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+      this->m_payload = ::new (static_cast<void*>(this->m_payload)) T(std::forward<Args>(args)...);
+      this->m_constructed = true;
+      return *this->m_payload;
+    }
+
+    T& operator*() const noexcept { return *this->m_payload; }
+    T* operator->() const noexcept { return this->m_payload; }
+  };
+
+private:
+  template <bool _finalize>
+  using index_queue_t = ::scq::cas1::bounded_index_queue_t<O, _finalize, W, S>;
+  struct alignas(T) storage_t {
+    std::byte bytes[sizeof(T)];
+  };
+  using slot_array_t  = std::array<storage_t, CAPACITY>;
+  /** The queue for storing the indices of committed slots. */
+  index_queue_t<finalize> m_aq;
+  /** The array storing the payloads. */
+  slot_array_t m_slots;
+  /** The queue for storing all available indices. */
+  index_queue_t<false> m_fq;
+
+  T* payload(std::size_t idx) noexcept;
+
+public:
+  /** constructor */
+  bounded_slot_queue_t() noexcept;
+  /** destructor, destroys all committed payloads that have not been peeked */
+  ~bounded_slot_queue_t();
+
+  /**
+   * Attempts to reserve a free slot, which must be either committed or
+   * cancelled and whose payload is not yet constructed.
+   */
+  bool try_reserve(slot_ref_t& slot, bool ignore_empty = false);
+  /**
+   * Commits a reserved slot with a constructed payload, making it available
+   * for consumers.
+   *
+   * Can only fail for finalized queues, in which case the payload is
+   * destroyed and the slot released.
+   */
+  bool commit(slot_ref_t slot);
+  /** Returns a reserved slot without committing it, destroying its payload if constructed. */
+  void cancel(slot_ref_t slot);
+  /** Attempts to access the slot at the start of the queue, which must be released. */
+  bool try_peek(slot_ref_t& slot);
+  /** Destroys the payload of a peeked slot and releases it for being reused by producers. */
+  void release(slot_ref_t slot);
 };
 }
 
@@ -0,0 +1,127 @@
+#ifndef SCQ_TRANSFER_QUEUE_HPP
+#define SCQ_TRANSFER_QUEUE_HPP
+
+#include <stdexcept>
+#include <thread>
+
+#include "scqueue/transfer_queue_fwd.hpp"
+#include "scqueue/scqd.hpp"
+
+namespace scq::d {
+template <typename T, std::size_t O, std::size_t WO>
+bool transfer_queue_t<T, O, WO>::try_enqueue(pointer elem) {
+  if (elem == nullptr) [[unlikely]] {
+    throw std::invalid_argument("`elem` must not be null");
+  }
+
+  std::size_t id;
+  // hand the element off to the first waiter, which has not cancelled, but
+  // only while the queue is empty, since enqueued elements must not be
+  // overtaken
+  while (this->m_queue.approx_size() <= 0 && this->m_waiting.try_dequeue(id)) {
+    auto& waiter = this->m_waiters[id];
+    // if elements have been enqueued in the meantime, the waiter is woken up
+    // to dequeue them instead
+    const auto filled = this->m_queue.approx_size() <= 0;
+    if (filled) {
+      waiter.m_item.store(elem, relaxed);
+    }
+
+    auto state = WAITING;
+    const auto next = filled ? FILLED : WOKEN;
+    if (waiter.m_state.compare_exchange_strong(state, next, acq_rel, acquire)) {
+      waiter.m_state.notify_one();
+      if (filled) {
+        return true;
+      }
+
+      break;
+    }
+
+    this->recycle(id);
+  }
+
+  if (!this->m_queue.try_enqueue(elem)) {
+    return false;
+  }
+
+  // a consumer may have started waiting after the check above but before the
+  // element was enqueued, so it must be woken up to dequeue it
+  std::atomic_thread_fence(seq_cst);
+  this->wake();
+  return true;
+}
+
+template <typename T, std::size_t O, std::size_t WO>
+bool transfer_queue_t<T, O, WO>::try_dequeue(pointer& result) {
+  return this->m_queue.try_dequeue(result);
+}
+
+template <typename T, std::size_t O, std::size_t WO>
+auto transfer_queue_t<T, O, WO>::dequeue_wait() -> pointer {
+  while (true) {
+    pointer result;
+    if (this->m_queue.try_dequeue(result)) {
+      return result;
+    }
+
+    std::size_t id;
+    if (!this->m_free.try_dequeue(id)) {
+      // all reservations are in use
+      std::this_thread::yield();
+      continue;
+    }
+
+    auto& waiter = this->m_waiters[id];
+    waiter.m_state.store(WAITING, relaxed);
+    (void) this->m_waiting.try_enqueue(id);
+
+    // an element may have been enqueued before the reservation was published,
+    // in which case the reservation is withdrawn again and its id is recycled
+    // by the producer that eventually dequeues it
+    std::atomic_thread_fence(seq_cst);
+    auto state = WAITING;
+    if (
+        this->m_queue.approx_size() > 0
+        && waiter.m_state.compare_exchange_strong(state, CANCELLED, acq_rel, acquire)
+    ) {
+      continue;
+    }
+
+    waiter.m_state.wait(WAITING, acquire);
+    state = waiter.m_state.load(acquire);
+    result = waiter.m_item.load(relaxed);
+    this->recycle(id);
+
+    if (state == FILLED) {
+      return result;
+    }
+  }
+}
+
+template <typename T, std::size_t O, std::size_t WO>
+void transfer_queue_t<T, O, WO>::wake() {
+  // waiters are woken for as long as elements remain, so none of them stays
+  // published to be filled by a later producer ahead of the enqueued elements
+  std::size_t id;
+  while (this->m_queue.approx_size() > 0 && this->m_waiting.try_dequeue(id)) {
+    auto& waiter = this->m_waiters[id];
+
+    auto state = WAITING;
+    if (waiter.m_state.compare_exchange_strong(state, WOKEN, acq_rel, acquire)) {
+      waiter.m_state.notify_one();
+      continue;
+    }
+
+    this->recycle(id);
+  }
+}
+
+template <typename T, std::size_t O, std::size_t WO>
+void transfer_queue_t<T, O, WO>::recycle(std::size_t id) {
+  this->m_waiters[id].m_state.store(IDLE, relaxed);
+  (void) this->m_free.try_enqueue(id);
+}
+}
+
+#endif /* SCQ_TRANSFER_QUEUE_HPP */
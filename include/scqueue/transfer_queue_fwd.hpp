@@ -0,0 +1,87 @@
+#ifndef SCQ_TRANSFER_QUEUE_FWD_HPP
+#define SCQ_TRANSFER_QUEUE_FWD_HPP
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+#include "scqueue/detail/scq1_fwd.hpp"
+#include "scqueue/scqd_fwd.hpp"
+
+namespace scq::d {
+/**
+ * A dual queue on top of `bounded_queue_t`, which hands elements directly to
+ * waiting consumers, if there are any and the queue is empty, and only
+ * enqueues them otherwise, so that elements are dequeued in FIFO order.
+ *
+ * Up to `2^WO` consumers can wait at the same time, any further consumers
+ * poll the queue instead.
+ */
+template <typename T, std::size_t O = 16, std::size_t WO = 6>
+class transfer_queue_t {
+public:
+  using pointer = T*;
+  static constexpr auto CAPACITY = std::size_t{ 1 } << O;
+  static constexpr auto WAITERS  = std::size_t{ 1 } << WO;
+private:
+  static_assert(WO >= 3, "there must be at least 8 waiters");
+  /** waiter states */
+  static constexpr auto IDLE      = std::uint32_t{ 0 };
+  static constexpr auto WAITING   = std::uint32_t{ 1 };
+  static constexpr auto FILLED    = std::uint32_t{ 2 };
+  static constexpr auto WOKEN     = std::uint32_t{ 3 };
+  static constexpr auto CANCELLED = std::uint32_t{ 4 };
+  /** type aliases */
+  using queue_t       = bounded_queue_t<T, O>;
+  using index_queue_t = ::scq::cas1::bounded_index_queue_t<WO, false, std::uint32_t>;
+  /** memory ordering constants */
+  static constexpr auto relaxed = std::memory_order_relaxed;
+  static constexpr auto acquire = std::memory_order_acquire;
+  static constexpr auto acq_rel = std::memory_order_acq_rel;
+  static constexpr auto seq_cst = std::memory_order_seq_cst;
+
+  /** A reservation published by a waiting consumer. */
+  struct alignas(128) waiter_t {
+    std::atomic<pointer>  m_item{ nullptr };
+    std::atomic_uint32_t  m_state{ IDLE };
+  };
+
+  /** Wakes up waiting consumers while the queue is not empty. */
+  void wake();
+  void recycle(std::size_t id);
+
+  /** The queue for elements, which could not be handed off. */
+  queue_t m_queue{ };
+  /**
+   * The ids of published reservations, every id is either in this queue, in
+   * `m_free` or held by a single thread, so neither queue holds more than
+   * `WAITERS` ids.
+   */
+  index_queue_t m_waiting{ index_queue_t::EMPTY };
+  /** The ids of unused reservations. */
+  index_queue_t m_free{ index_queue_t::FILLED };
+  /** The reservations. */
+  std::array<waiter_t, WAITERS> m_waiters{ };
+
+public:
+  /** constructor */
+  transfer_queue_t() noexcept = default;
+  ~transfer_queue_t() = default;
+
+  /**
+   * Hands the element to a waiting consumer or, if there is none, attempts to
+   * enqueue it.
+   *
+   * @return true upon success, false if no consumer is waiting and the queue
+   *   is full
+   * @throws `std::invalid_argument` exception, if `elem` is `nullptr`
+   */
+  bool try_enqueue(pointer elem);
+  /** Attempts to dequeue an element without waiting. */
+  bool try_dequeue(pointer& result);
+  /** Dequeues an element, waiting for a producer if the queue is empty. */
+  pointer dequeue_wait();
+};
+}
+
+#endif /* SCQ_TRANSFER_QUEUE_FWD_HPP */
@@ -0,0 +1,157 @@
+#ifndef SCQ_TEST_QUEUE_TESTS_HPP
+#define SCQ_TEST_QUEUE_TESTS_HPP
+
+#include <stdexcept>
+#include <vector>
+
+// tests shared by the pointer queues of `scq::cas2` and `scq::d`
+
+template <typename Q>
+int test_overwrite() {
+  auto queue = Q{ };
+  int elems[2 * Q::CAPACITY];
+  for (auto i = 0; i < 2 * Q::CAPACITY; ++i) {
+    elems[i] = i;
+  }
+
+  auto dropped = 0;
+  for (auto& elem : elems) {
+    queue.enqueue_overwrite(&elem, [&](int* oldest) {
+      if (*oldest != dropped) {
+        throw std::runtime_error("dropped wrong element");
+      }
+
+      dropped += 1;
+    });
+  }
+
+  if (dropped != Q::CAPACITY || queue.dropped_count() != Q::CAPACITY) {
+    throw std::runtime_error("wrong number of dropped elements");
+  }
+
+  int* res;
+  for (auto i = 0; i < Q::CAPACITY; ++i) {
+    if (!queue.try_dequeue(res)) {
+      throw std::runtime_error("dequeue failed on non-empty queue");
+    }
+
+    if (*res != Q::CAPACITY + i) {
+      throw std::runtime_error("dequeued wrong element");
+    }
+  }
+
+  if (queue.try_dequeue(res)) {
+    throw std::runtime_error("dequeued should have failed on empty queue");
+  }
+
+  return 0;
+}
+
+template <typename Q>
+int test_watermarks() {
+  auto queue = Q{ };
+  auto crossings = std::vector<bool>{ };
+  queue.set_watermarks(2, 6, [&](bool above) { crossings.push_back(above); });
+
+  int elem = 1;
+  for (auto i = 0; i < Q::CAPACITY; ++i) {
+    if (!queue.try_enqueue(&elem)) {
+      throw std::runtime_error("enqueue failed on non-full queue");
+    }
+  }
+
+  if (crossings != std::vector<bool>{ true } || !queue.above_watermark()) {
+    throw std::runtime_error("high watermark must be crossed exactly once");
+  }
+
+  int* res;
+  // the occupancy drops to 3, which is still above the low watermark
+  for (auto i = 0; i < 5; ++i) {
+    if (!queue.try_dequeue(res)) {
+      throw std::runtime_error("dequeue failed on non-empty queue");
+    }
+  }
+
+  if (!queue.above_watermark()) {
+    throw std::runtime_error("low watermark must not be crossed yet");
+  }
+
+  while (queue.try_dequeue(res));
+  if (crossings != std::vector<bool>{ true, false } || queue.above_watermark()) {
+    throw std::runtime_error("low watermark must be crossed exactly once");
+  }
+
+  return 0;
+}
+
+template <typename Q>
+int test_close_drain() {
+  auto queue = Q{ };
+  int elems[5] = { 0, 1, 2, 3, 4 };
+  for (auto& elem : elems) {
+    if (!queue.try_enqueue(&elem)) {
+      throw std::runtime_error("enqueue failed on non-full queue");
+    }
+  }
+
+  if (queue.closed_and_empty()) {
+    throw std::runtime_error("queue must not be closed yet");
+  }
+
+  auto drained = std::vector<int>{ };
+  // draining an open queue stops once it is empty, but does not report it as
+  // closed and empty
+  if (queue.drain([&](int* elem) { drained.push_back(*elem); })) {
+    throw std::runtime_error("open queue must not be reported as closed and empty");
+  }
+
+  for (auto elem : drained) {
+    if (!queue.try_enqueue(&elems[elem])) {
+      throw std::runtime_error("enqueue failed on non-full queue");
+    }
+  }
+
+  drained.clear();
+  queue.close();
+  // rejected enqueues must neither count as elements nor keep the queue from
+  // becoming empty
+  for (auto i = 0; i < 3; ++i) {
+    if (queue.try_enqueue(&elems[0])) {
+      throw std::runtime_error("enqueue should have failed on closed queue");
+    }
+  }
+
+  if (queue.approx_size() != 5) {
+    throw std::runtime_error("rejected enqueues must not change the size");
+  }
+
+  // elements enqueued before closing remain available in FIFO order
+  if (queue.try_dequeue_bulk(2, [&](int* elem) { drained.push_back(*elem); }) != 2) {
+    throw std::runtime_error("bulk dequeue failed on non-empty queue");
+  }
+
+  if (!queue.drain([&](int* elem) { drained.push_back(*elem); })) {
+    throw std::runtime_error("closed queue must be empty after draining");
+  }
+
+  if (drained != std::vector<int>{ 0, 1, 2, 3, 4 }) {
+    throw std::runtime_error("drained wrong elements");
+  }
+
+  int* res;
+  if (queue.try_dequeue(res) || queue.try_dequeue_bulk(4, [](int*) {}) != 0) {
+    throw std::runtime_error("dequeue should have failed on drained queue");
+  }
+
+  if (!queue.closed_and_empty() || queue.approx_size() != 0) {
+    throw std::runtime_error("drained queue must be closed and empty");
+  }
+
+  if (queue.drain_until_closed([](int*) {}) != 0) {
+    throw std::runtime_error("drained queue must not return any elements");
+  }
+
+  return 0;
+}
+
+#endif /* SCQ_TEST_QUEUE_TESTS_HPP */
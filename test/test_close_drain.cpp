@@ -0,0 +1,93 @@
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "scqueue/scq2.hpp"
+#include "scqueue/scqd.hpp"
+
+// closable queues close once they are full, so all elements of a round must
+// fit in at once
+using cas2_queue_t = scq::cas2::bounded_queue_t<int, 10, true>;
+using scqd_queue_t = scq::d::bounded_queue_t<int, 10, true>;
+
+template <typename Q>
+int test_drain_until_closed(const char* name);
+
+int main() {
+  test_drain_until_closed<cas2_queue_t>("cas2");
+  test_drain_until_closed<scqd_queue_t>("scqd");
+  std::cout << "test successful" << std::endl;
+}
+
+/**
+ * Lets consumers block in `drain_until_closed` while producers enqueue with
+ * pauses, then closes the queue: every drainer must return and all elements
+ * must have been drained exactly once.
+ */
+template <typename Q>
+int test_drain_until_closed(const char* name) {
+  const std::size_t rounds = 50;
+  const std::size_t producer_count = 4;
+  const std::size_t drainer_count = 2;
+  const std::size_t count = 200;
+
+  std::vector<int> elements{ };
+  for (auto i = 0; i < count; ++i) {
+    elements.push_back(i);
+  }
+
+  for (std::size_t round = 0; round < rounds; ++round) {
+    auto queue = std::make_unique<Q>();
+    std::atomic_uint64_t sum{ 0 };
+    std::atomic_size_t drained{ 0 };
+
+    std::vector<std::thread> drainers{ };
+    for (auto thread = 0; thread < drainer_count; ++thread) {
+      drainers.emplace_back([&] {
+        std::uint64_t thread_sum = 0;
+        drained.fetch_add(queue->drain_until_closed([&](int* elem) { thread_sum += *elem; }));
+        sum.fetch_add(thread_sum);
+      });
+    }
+
+    std::vector<std::thread> producers{ };
+    for (auto thread = 0; thread < producer_count; ++thread) {
+      producers.emplace_back([&] {
+        for (auto op = 0; op < count; ++op) {
+          if (!queue->try_enqueue(&elements[op])) {
+            throw std::runtime_error("enqueue failed on open, non-full queue");
+          }
+
+          // leave drainers time to run out of elements and park
+          if (op % 16 == 0) {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+
+    for (auto& thread : producers) {
+      thread.join();
+    }
+
+    queue->close();
+    for (auto& thread : drainers) {
+      thread.join();
+    }
+
+    if (drained.load() != producer_count * count || !queue->closed_and_empty()) {
+      throw std::runtime_error(std::string{ name } + ": not all elements have been drained");
+    }
+
+    if (sum.load() != producer_count * (count * (count - 1) / 2)) {
+      throw std::runtime_error(std::string{ name } + ": incorrect element sum");
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,178 @@
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "scqueue/delay_queue.hpp"
+
+struct test_timer_t {
+  std::uintmax_t    deadline;
+  std::atomic_bool  fired{ false };
+};
+
+using delay_queue_t = scq::timer::delay_queue_t<test_timer_t, 10, 4, 3>;
+/** two wheels of four buckets with room for eight timers each */
+using small_queue_t = scq::timer::delay_queue_t<test_timer_t, 3, 2, 2>;
+
+int test_ordering();
+int test_full_bucket();
+int test_concurrent();
+
+int main() {
+  test_ordering();
+  test_full_bucket();
+  test_concurrent();
+  std::cout << "test successful" << std::endl;
+}
+
+int test_ordering() {
+  auto queue = std::make_unique<delay_queue_t>();
+  // spans all three wheels (16 * 16 * 16 ticks) and beyond
+  std::vector<test_timer_t> timers(5'000);
+  for (auto i = 0; i < timers.size(); ++i) {
+    timers[i].deadline = (i * 7) % timers.size();
+    if (!queue->schedule(&timers[i])) {
+      throw std::runtime_error("schedule failed on non-full bucket");
+    }
+  }
+
+  std::size_t fired = 0;
+  for (std::uintmax_t now = 0; now < timers.size(); ++now) {
+    fired += queue->advance(now, [&](test_timer_t* timer) {
+      if (timer->deadline != now) {
+        throw std::runtime_error("timer fired at the wrong tick");
+      }
+
+      if (timer->fired.exchange(true)) {
+        throw std::runtime_error("timer fired twice");
+      }
+    });
+  }
+
+  if (fired != timers.size()) {
+    throw std::runtime_error("not all timers have fired");
+  }
+
+  return 0;
+}
+
+int test_full_bucket() {
+  auto queue = std::make_unique<small_queue_t>();
+  const auto capacity = small_queue_t::BUCKET_CAPACITY;
+  // placed in the second wheel's bucket for ticks 4 to 7
+  std::vector<test_timer_t> coarse(capacity);
+  for (auto& timer : coarse) {
+    timer.deadline = 5;
+    if (!queue->schedule(&timer)) {
+      throw std::runtime_error("schedule failed on non-full bucket");
+    }
+  }
+
+  std::size_t fired = 0;
+  const auto on_fire = [&](std::uintmax_t now) {
+    return [&, now](test_timer_t* timer) {
+      if (timer->deadline > now) {
+        throw std::runtime_error("timer fired early");
+      }
+
+      if (timer->fired.exchange(true)) {
+        throw std::runtime_error("timer fired twice");
+      }
+    };
+  };
+
+  for (std::uintmax_t now = 0; now < 4; ++now) {
+    fired += queue->advance(now, on_fire(now));
+  }
+
+  // fills the first wheel's bucket for tick 5, which is also the fallback
+  // bucket while tick 4 is processed, so the coarse timers can not be
+  // cascaded and must be kept
+  std::vector<test_timer_t> fine(capacity);
+  for (auto& timer : fine) {
+    timer.deadline = 5;
+    if (!queue->schedule(&timer)) {
+      throw std::runtime_error("schedule failed on non-full bucket");
+    }
+  }
+
+  fired += queue->advance(4, on_fire(4));
+  if (fired != 0) {
+    throw std::runtime_error("timers fired before their deadline");
+  }
+
+  for (std::uintmax_t now = 5; now < 8; ++now) {
+    fired += queue->advance(now, on_fire(now));
+  }
+
+  if (fired != 2 * capacity) {
+    throw std::runtime_error("not all timers have fired");
+  }
+
+  return 0;
+}
+
+int test_concurrent() {
+  const std::size_t thread_count = 4;
+  const std::size_t count = 1'024;
+  const std::uintmax_t last_tick = 2'048;
+
+  auto queue = std::make_unique<delay_queue_t>();
+  std::vector<std::vector<test_timer_t>> thread_timers(thread_count);
+
+  std::atomic_bool start{ false };
+  std::atomic_size_t fired{ 0 };
+  std::atomic_size_t scheduled{ 0 };
+
+  const auto on_fire = [&](test_timer_t* timer) {
+    if (timer->deadline > queue->next_tick()) {
+      throw std::runtime_error("timer fired early");
+    }
+
+    if (timer->fired.exchange(true)) {
+      throw std::runtime_error("timer fired twice");
+    }
+  };
+
+  std::vector<std::thread> threads{ };
+  for (auto thread = 0; thread < thread_count; ++thread) {
+    thread_timers[thread] = std::vector<test_timer_t>(count);
+    threads.emplace_back([&, thread] {
+      while (!start.load());
+
+      for (auto i = 0; i < count; ++i) {
+        auto& timer = thread_timers[thread][i];
+        timer.deadline = queue->next_tick() + (i * 13) % 300;
+        while (!queue->schedule(&timer));
+        scheduled.fetch_add(1);
+      }
+    });
+  }
+
+  // driver thread
+  threads.emplace_back([&] {
+    while (!start.load());
+
+    for (std::uintmax_t now = 0; now < last_tick; ++now) {
+      fired.fetch_add(queue->advance(now, on_fire));
+    }
+  });
+
+  start.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // fire all remaining timers
+  fired.fetch_add(queue->advance(last_tick + 4'096, on_fire));
+  fired.fetch_add(queue->advance(last_tick + 4'096, on_fire));
+
+  if (fired.load() != thread_count * count) {
+    throw std::runtime_error("not all timers have fired");
+  }
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "scqueue/scqd.hpp"
+
+// far smaller than the magazines of all consumers combined
+using bounded_queue_t = scq::d::bounded_queue_t<int, 3>;
+
+int main() {
+  const std::size_t thread_count = 4;
+  const std::size_t count = 16'384;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 60 };
+
+  auto queue = std::make_unique<bounded_queue_t>();
+  std::vector<std::vector<int>> thread_elements(thread_count);
+  for (auto& elements : thread_elements) {
+    for (auto i = 0; i < count; ++i) {
+      elements.push_back(i);
+    }
+  }
+
+  std::atomic_bool start{ false };
+  std::atomic_bool stalled{ false };
+  std::atomic_uint64_t sum{ 0 };
+  std::atomic_size_t consumed{ 0 };
+
+  const auto wait = [&] {
+    if (std::chrono::steady_clock::now() > deadline) {
+      stalled.store(true);
+    }
+
+    std::this_thread::yield();
+  };
+
+  std::vector<std::thread> threads{ };
+  for (auto thread = 0; thread < thread_count; ++thread) {
+    // producer thread, every other one without a magazine
+    threads.emplace_back([&, thread] {
+      while (!start.load());
+
+      auto magazine = bounded_queue_t::magazine_t{ *queue };
+      for (auto op = 0; op < count && !stalled.load(); ++op) {
+        auto elem = &thread_elements[thread][op];
+        while (!(thread % 2 == 0 ? queue->try_enqueue(magazine, elem) : queue->try_enqueue(elem))) {
+          wait();
+          if (stalled.load()) {
+            break;
+          }
+        }
+      }
+    });
+
+    // consumer thread
+    threads.emplace_back([&] {
+      std::uint64_t thread_sum = 0;
+      while (!start.load());
+
+      auto magazine = bounded_queue_t::magazine_t{ *queue };
+      while (consumed.load() < thread_count * count && !stalled.load()) {
+        int* deq;
+        if (queue->try_dequeue(magazine, deq)) {
+          thread_sum += *deq;
+          consumed.fetch_add(1);
+        } else {
+          wait();
+        }
+      }
+
+      sum.fetch_add(thread_sum);
+    });
+  }
+
+  start.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (stalled.load()) {
+    throw std::runtime_error("producers starved by indices cached in consumers' magazines");
+  }
+
+  const auto expected = thread_count * (count * (count - 1) / 2);
+  if (sum.load() != expected) {
+    std::cerr << "sum: " << sum.load() << ", expected: " << expected << std::endl;
+    throw std::runtime_error("wrong sum of dequeued elements");
+  }
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "scqueue/partitioned_queue.hpp"
+
+struct message_t {
+  std::size_t key;
+  std::size_t seq;
+};
+
+using partitioned_queue_t = scq::partition::partitioned_queue_t<message_t, 3, 10>;
+
+int main() {
+  const std::size_t thread_count = 4;
+  const std::size_t keys_per_thread = 16;
+  const std::size_t count = 16'384;
+  const std::size_t key_count = thread_count * keys_per_thread;
+
+  auto queue = std::make_unique<partitioned_queue_t>();
+
+  std::vector<std::vector<message_t>> thread_messages(thread_count);
+  std::vector<std::atomic_size_t> next_seq(key_count);
+  std::atomic_size_t consumed{ 0 };
+  std::atomic_bool start{ false };
+
+  std::vector<std::thread> threads{ };
+  for (auto thread = 0; thread < thread_count; ++thread) {
+    // producer thread, each key is only produced by a single thread
+    threads.emplace_back([&, thread] {
+      auto& messages = thread_messages[thread];
+      messages.resize(count);
+      while (!start.load());
+
+      for (std::size_t i = 0; i < count; ++i) {
+        const auto key = thread * keys_per_thread + i % keys_per_thread;
+        messages[i] = message_t{ key, i / keys_per_thread };
+        while (!queue->try_enqueue(key, &messages[i]));
+      }
+    });
+
+    // consumer thread
+    threads.emplace_back([&] {
+      while (!start.load());
+
+      while (consumed.load() < thread_count * count) {
+        const auto batch = queue->drain_batch(32, [&](message_t* msg) {
+          // only the owner of the partition can advance the key's sequence
+          if (next_seq[msg->key].load() != msg->seq) {
+            throw std::runtime_error("messages of the same key consumed out of order");
+          }
+
+          next_seq[msg->key].store(msg->seq + 1);
+        });
+
+        consumed.fetch_add(batch);
+      }
+    });
+  }
+
+  start.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (std::size_t key = 0; key < key_count; ++key) {
+    if (next_seq[key].load() != count / keys_per_thread) {
+      throw std::runtime_error("not all messages have been consumed");
+    }
+  }
+
+  std::size_t partition;
+  if (queue->try_claim(partition)) {
+    throw std::runtime_error("no partition should be ready after consuming all messages");
+  }
+
+  std::cout << "test successful" << std::endl;
+  return 0;
+}
@@ -8,7 +8,7 @@
 #include "scqueue/scqd.hpp"
 #include "scqueue/scq2.hpp"
 
-template <typename Q>
+template <typename Q, bool use_handles = false>
 int test_queue();
 
 int main(int argc, const char* argv[]) {
@@ -19,14 +19,24 @@ int main(int argc, const char* argv[]) {
   const auto queue = std::string_view{ argv[1] };
   if (queue == "scq2") {
     return test_queue<scq::cas2::bounded_queue_t<int, 16>>();
+  } else if (queue == "scq2_handles") {
+    return test_queue<scq::cas2::bounded_queue_t<int, 16>, true>();
+  } else if (queue == "scq2_striped") {
+    return test_queue<scq::cas2::bounded_queue_t<int, 16, false, 8>>();
   } else if (queue == "scqd") {
     return test_queue<scq::d::bounded_queue_t<int, 16>>();
+  } else if (queue == "scqd_compact") {
+    return test_queue<scq::d::bounded_queue_t<int, 16, false, std::uint32_t>>();
+  } else if (queue == "scqd_magazines") {
+    return test_queue<scq::d::bounded_queue_t<int, 16>, true>();
+  } else if (queue == "scqd_striped") {
+    return test_queue<scq::d::bounded_queue_t<int, 16, false, std::uintmax_t, 8>>();
   }
 
   throw std::invalid_argument("invalid queue argument");
 }
 
-template <typename Q>
+template <typename Q, bool use_handles>
 int test_queue() {
   const std::uint64_t thread_count = 16;
   const std::uint64_t count = 32768;
@@ -57,8 +67,20 @@ int test_queue() {
     threads.emplace_back([&, thread] {
       while (!start.load());
 
-      for (auto op = 0; op < count; ++op) {
-        while (!queue.try_enqueue(&thread_elements[thread][op]));
+      if constexpr (use_handles && requires { typename Q::magazine_t; }) {
+        auto magazine = typename Q::magazine_t{ queue };
+        for (auto op = 0; op < count; ++op) {
+          while (!queue.try_enqueue(magazine, &thread_elements[thread][op]));
+        }
+      } else if constexpr (use_handles) {
+        auto handle = typename Q::producer_handle_t{ };
+        for (auto op = 0; op < count; ++op) {
+          while (!queue.try_enqueue(handle, &thread_elements[thread][op]));
+        }
+      } else {
+        for (auto op = 0; op < count; ++op) {
+          while (!queue.try_enqueue(&thread_elements[thread][op]));
+        }
       }
     });
 
@@ -69,12 +91,33 @@ int test_queue() {
 
       while (!start.load()) {}
 
-      while (deq_count < count) {
-        int* deq;
-        const auto res = queue.try_dequeue(deq);
-        if (res) {
-          thread_sum += *deq;
-          deq_count += 1;
+      const auto consume = [&](int* deq) {
+        thread_sum += *deq;
+        deq_count += 1;
+      };
+
+      if constexpr (use_handles && requires { typename Q::magazine_t; }) {
+        auto magazine = typename Q::magazine_t{ queue };
+        while (deq_count < count) {
+          int* deq;
+          if (queue.try_dequeue(magazine, deq)) {
+            consume(deq);
+          }
+        }
+      } else if constexpr (use_handles) {
+        auto handle = typename Q::consumer_handle_t{ };
+        while (deq_count < count) {
+          int* deq;
+          if (queue.try_dequeue(handle, deq)) {
+            consume(deq);
+          }
+        }
+      } else {
+        while (deq_count < count) {
+          int* deq;
+          if (queue.try_dequeue(deq)) {
+            consume(deq);
+          }
         }
       }
 
@@ -1,18 +1,29 @@
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 #include "scqueue/scq2.hpp"
 
+#include "queue_tests.hpp"
+
 using bounded_queue_t = scq::cas2::bounded_queue_t<int, 3, true>;
+using lossy_queue_t   = scq::cas2::bounded_queue_t<int, 3, false>;
 
 int test_with_first();
 int test_capacity();
 int test_finalize();
+int test_handles();
+int test_stale_watermark();
 
 int main() {
   test_with_first();
   test_capacity();
   test_finalize();
+  test_handles();
+  test_overwrite<lossy_queue_t>();
+  test_watermarks<lossy_queue_t>();
+  test_stale_watermark();
+  test_close_drain<bounded_queue_t>();
 }
 
 int test_with_first() {
@@ -118,3 +129,74 @@ int test_finalize() {
 
   return 0;
 }
+
+int test_handles() {
+  auto queue = bounded_queue_t{ };
+  auto producer = bounded_queue_t::producer_handle_t{ };
+  auto consumer = bounded_queue_t::consumer_handle_t{ };
+  int elem = 1;
+
+  for (auto i = 0; i < bounded_queue_t::CAPACITY; ++i) {
+    if (!queue.try_enqueue(producer, &elem)) {
+      throw std::runtime_error("enqueue failed on non-full queue");
+    }
+  }
+
+  if (queue.try_enqueue(producer, &elem)) {
+    throw std::runtime_error("enqueue should have failed on full queue");
+  }
+
+  int* res;
+  for (auto i = 0; i < bounded_queue_t::CAPACITY; ++i) {
+    if (!queue.try_dequeue(consumer, res)) {
+      throw std::runtime_error("dequeue failed on non-empty queue");
+    }
+  }
+
+  if (queue.try_dequeue(consumer, res)) {
+    throw std::runtime_error("dequeued should have failed on empty queue");
+  }
+
+  const auto& enq_stats = producer.stats;
+  if (enq_stats.succeeded != bounded_queue_t::CAPACITY || enq_stats.failed != 1) {
+    throw std::runtime_error("wrong producer handle statistics");
+  }
+
+  // the head only needs to be loaded initially and once the queue fills up
+  if (enq_stats.reloads > 2) {
+    throw std::runtime_error("producer handle reloaded the head too often");
+  }
+
+  const auto& deq_stats = consumer.stats;
+  if (deq_stats.succeeded != bounded_queue_t::CAPACITY || deq_stats.failed != 1) {
+    throw std::runtime_error("wrong consumer handle statistics");
+  }
+
+  return 0;
+}
+
+int test_stale_watermark() {
+  auto watermark = scq::detail::watermark_t{ };
+  auto crossings = std::vector<bool>{ };
+  watermark.configure(2, 6, [&](bool above) { crossings.push_back(above); });
+
+  // the queue has been drained after the occupancy was read, so the flip to
+  // "above" must be undone, since no dequeue would ever undo it otherwise
+  watermark.after_enqueue(6, [] { return std::intmax_t{ 0 }; });
+  if (watermark.above() || !crossings.empty()) {
+    throw std::runtime_error("flip based on stale occupancy must be undone");
+  }
+
+  watermark.after_enqueue(7, [] { return std::intmax_t{ 4 }; });
+  watermark.after_dequeue(1, [] { return std::intmax_t{ 8 }; });
+  if (!watermark.above() || crossings != std::vector<bool>{ true }) {
+    throw std::runtime_error("flip based on stale occupancy must be undone");
+  }
+
+  watermark.after_dequeue(2, [] { return std::intmax_t{ 2 }; });
+  if (watermark.above() || crossings != std::vector<bool>{ true, false }) {
+    throw std::runtime_error("low watermark must be crossed exactly once");
+  }
+
+  return 0;
+}
@@ -0,0 +1,260 @@
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "scqueue/scqd.hpp"
+
+#include "queue_tests.hpp"
+
+using message_t = std::array<char, 32>;
+using bounded_slot_queue_t = scq::d::bounded_slot_queue_t<message_t, 3>;
+using bounded_queue_t      = scq::d::bounded_queue_t<int, 3>;
+using closable_queue_t     = scq::d::bounded_queue_t<int, 3, true>;
+
+static_assert(
+    sizeof(scq::cas1::bounded_index_queue_t<10, false, std::uint32_t>)
+    < sizeof(scq::cas1::bounded_index_queue_t<10, false>),
+    "compact index queue must be smaller"
+);
+
+int test_reserve_commit();
+int test_cancel();
+int test_payload_lifetime();
+int test_magazines();
+int test_cycle_wraparound();
+
+int main() {
+  test_reserve_commit();
+  test_cancel();
+  test_payload_lifetime();
+  test_overwrite<bounded_queue_t>();
+  test_watermarks<bounded_queue_t>();
+  test_magazines();
+  test_cycle_wraparound();
+  test_close_drain<closable_queue_t>();
+}
+
+int test_reserve_commit() {
+  auto queue = bounded_slot_queue_t{ };
+  static_assert(bounded_slot_queue_t::CAPACITY == 8);
+
+  bounded_slot_queue_t::slot_ref_t slot;
+  for (auto i = 0; i < bounded_slot_queue_t::CAPACITY; ++i) {
+    if (!queue.try_reserve(slot)) {
+      throw std::runtime_error("reserve failed on non-full queue");
+    }
+
+    slot.emplace()[0] = static_cast<char>('a' + i);
+    if (!queue.commit(slot)) {
+      throw std::runtime_error("commit failed on non-finalized queue");
+    }
+  }
+
+  if (queue.try_reserve(slot)) {
+    throw std::runtime_error("reserve should have failed on full queue");
+  }
+
+  for (auto i = 0; i < bounded_slot_queue_t::CAPACITY; ++i) {
+    if (!queue.try_peek(slot)) {
+      throw std::runtime_error("peek failed on non-empty queue");
+    }
+
+    if ((*slot)[0] != static_cast<char>('a' + i)) {
+      throw std::runtime_error("peeked wrong element");
+    }
+
+    queue.release(slot);
+  }
+
+  if (queue.try_peek(slot)) {
+    throw std::runtime_error("peek should have failed on empty queue");
+  }
+
+  return 0;
+}
+
+int test_cancel() {
+  auto queue = bounded_slot_queue_t{ };
+
+  bounded_slot_queue_t::slot_ref_t slot;
+  for (auto i = 0; i < 2 * bounded_slot_queue_t::CAPACITY; ++i) {
+    if (!queue.try_reserve(slot)) {
+      throw std::runtime_error("reserve failed after cancelled reservations");
+    }
+
+    queue.cancel(slot);
+  }
+
+  if (queue.try_peek(slot)) {
+    throw std::runtime_error("cancelled slots must not be visible to consumers");
+  }
+
+  return 0;
+}
+
+int test_payload_lifetime() {
+  // neither default-constructible nor trivially destructible
+  struct payload_t {
+    int& live;
+    int  val;
+
+    payload_t(int& live, int val) : live{ live }, val{ val } { this->live += 1; }
+    ~payload_t() { this->live -= 1; }
+  };
+
+  int live = 0;
+  {
+    auto queue = scq::d::bounded_slot_queue_t<payload_t, 3>{ };
+    if (live != 0) {
+      throw std::runtime_error("payloads must not be constructed by the queue");
+    }
+
+    decltype(queue)::slot_ref_t slot;
+    for (auto i = 0; i < 4; ++i) {
+      if (!queue.try_reserve(slot)) {
+        throw std::runtime_error("reserve failed on non-full queue");
+      }
+
+      slot.emplace(live, i);
+      if (!queue.commit(slot)) {
+        throw std::runtime_error("commit failed on non-finalized queue");
+      }
+    }
+
+    // cancelling a constructed payload destroys it
+    if (!queue.try_reserve(slot)) {
+      throw std::runtime_error("reserve failed on non-full queue");
+    }
+
+    slot.emplace(live, -1);
+    queue.cancel(slot);
+
+    if (!queue.try_peek(slot) || slot->val != 0) {
+      throw std::runtime_error("peeked wrong element");
+    }
+
+    queue.release(slot);
+    if (live != 3) {
+      throw std::runtime_error("released and cancelled payloads must be destroyed");
+    }
+  }
+
+  if (live != 0) {
+    throw std::runtime_error("remaining payloads must be destroyed with the queue");
+  }
+
+  return 0;
+}
+
+int test_magazines() {
+  auto queue = bounded_queue_t{ };
+  int elem = 1;
+  int* res;
+
+  auto producer = bounded_queue_t::magazine_t{ queue };
+  {
+    auto consumer = bounded_queue_t::magazine_t{ queue };
+    for (auto i = 0; i < bounded_queue_t::CAPACITY; ++i) {
+      if (!queue.try_enqueue(producer, &elem)) {
+        throw std::runtime_error("enqueue failed on non-full queue");
+      }
+    }
+
+    if (queue.try_enqueue(producer, &elem)) {
+      throw std::runtime_error("enqueue should have failed on full queue");
+    }
+
+    // the consumer caches freed indices up to the limit
+    for (auto i = 0; i < bounded_queue_t::CAPACITY; ++i) {
+      if (!queue.try_dequeue(consumer, res)) {
+        throw std::runtime_error("dequeue failed on non-empty queue");
+      }
+    }
+  }
+
+  // the consumer's magazine has been flushed on destruction
+  for (auto i = 0; i < bounded_queue_t::CAPACITY; ++i) {
+    if (!queue.try_enqueue(producer, &elem)) {
+      throw std::runtime_error("indices cached by a magazine have been lost");
+    }
+  }
+
+  // indices freed by a thread are reused by the same thread
+  for (auto i = 0; i < 4 * bounded_queue_t::CAPACITY; ++i) {
+    if (!queue.try_dequeue(producer, res) || !queue.try_enqueue(producer, &elem)) {
+      throw std::runtime_error("failed to reuse cached index");
+    }
+  }
+
+  // an idle consumer's magazine must neither make an empty queue appear full
+  // nor keep overwriting enqueues from making progress
+  auto idle_queue = bounded_queue_t{ };
+  auto idle = bounded_queue_t::magazine_t{ idle_queue };
+  for (auto i = 0; i < bounded_queue_t::CAPACITY; ++i) {
+    if (!idle_queue.try_enqueue(&elem)) {
+      throw std::runtime_error("enqueue failed on non-full queue");
+    }
+  }
+
+  for (auto i = 0; i < bounded_queue_t::CAPACITY; ++i) {
+    if (!idle_queue.try_dequeue(idle, res)) {
+      throw std::runtime_error("dequeue failed on non-empty queue");
+    }
+  }
+
+  if (idle_queue.approx_size() != 0) {
+    throw std::runtime_error("queue must be empty");
+  }
+
+  const auto available = bounded_queue_t::CAPACITY - bounded_queue_t::CACHE_LIMIT;
+  for (auto i = 0; i < available; ++i) {
+    if (!idle_queue.try_enqueue(&elem)) {
+      throw std::runtime_error("indices cached by an idle magazine made the queue appear full");
+    }
+  }
+
+  for (auto i = 0; i < 2 * bounded_queue_t::CAPACITY; ++i) {
+    idle_queue.enqueue_overwrite(&elem);
+  }
+
+  return 0;
+}
+
+int test_cycle_wraparound() {
+  // the cycles of 16-bit slots wrap around after every 2^15 enqueues, so
+  // the loop below goes through about 9 full wraps
+  using compact_queue_t = scq::d::bounded_queue_t<int, 3, false, std::uint16_t>;
+  auto queue = compact_queue_t{ };
+
+  int elems[compact_queue_t::CAPACITY];
+  int* res;
+  for (auto lap = 0; lap < 64 * 1024; ++lap) {
+    // vary the fill level, so the head and tail meet at every offset
+    const auto count = lap % compact_queue_t::CAPACITY + 1;
+    for (auto i = 0; i < count; ++i) {
+      elems[i] = lap + i;
+      if (!queue.try_enqueue(&elems[i])) {
+        throw std::runtime_error("enqueue failed on non-full queue");
+      }
+    }
+
+    // failing operations are slow, so the capacity is only checked occasionally
+    const auto check = lap % 64 == compact_queue_t::CAPACITY - 1;
+    if (check && queue.try_enqueue(&elems[0])) {
+      throw std::runtime_error("enqueue should have failed on full queue");
+    }
+
+    for (auto i = 0; i < count; ++i) {
+      if (!queue.try_dequeue(res) || *res != lap + i) {
+        throw std::runtime_error("dequeued wrong element after cycle wraparound");
+      }
+    }
+
+    if (check && queue.try_dequeue(res)) {
+      throw std::runtime_error("dequeue should have failed on empty queue");
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "scqueue/detail/detail.hpp"
+
+constexpr auto THRESHOLD = std::intmax_t{ 15 };
+// many stripes widen the window between an enqueuer starting to reset the
+// threshold and resetting the last stripe
+constexpr auto STRIPES   = std::size_t{ 1 } << 10;
+
+using threshold_t = scq::detail::threshold_t<THRESHOLD, STRIPES>;
+
+/**
+ * Exhausts one stripe and lets two enqueuers refresh the threshold
+ * concurrently: once either of them has returned, the stripe must no longer
+ * be exhausted, even if the other one is still resetting.
+ */
+int main() {
+  const std::size_t rounds = 20'000;
+
+  // the checker is assigned the last stripe, which is the last to be reset
+  for (auto i = 0; i < STRIPES - 1; ++i) {
+    std::thread([] { (void) scq::detail::thread_stripe(); }).join();
+  }
+
+  auto threshold_ptr = std::make_unique<threshold_t>(-1);
+  auto& threshold = *threshold_ptr;
+  std::atomic_size_t round{ 0 };
+  std::atomic_size_t returned{ 0 };
+  std::atomic_size_t done{ 0 };
+
+  std::vector<std::thread> enqueuers{ };
+  for (auto thread = 0; thread < 2; ++thread) {
+    enqueuers.emplace_back([&] {
+      for (std::size_t r = 1; r <= rounds; ++r) {
+        while (round.load(std::memory_order_acquire) != r) {
+          std::this_thread::yield();
+        }
+
+        // the weakest order a call site may pass, the flag is still acquired
+        threshold.refresh(std::memory_order_relaxed);
+        returned.store(r, std::memory_order_release);
+        done.fetch_add(1, std::memory_order_release);
+      }
+    });
+  }
+
+  std::size_t failures = 0;
+  std::thread checker([&] {
+    for (std::size_t r = 1; r <= rounds; ++r) {
+      while (!threshold.exhausted(std::memory_order_acquire)) {
+        (void) threshold.decrement();
+      }
+
+      round.store(r, std::memory_order_release);
+      while (returned.load(std::memory_order_acquire) != r) {
+        std::this_thread::yield();
+      }
+
+      if (threshold.exhausted(std::memory_order_acquire)) {
+        failures += 1;
+      }
+
+      while (done.load(std::memory_order_acquire) != 2 * r) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  checker.join();
+  for (auto& thread : enqueuers) {
+    thread.join();
+  }
+
+  if (failures != 0) {
+    std::cerr << failures << " of " << rounds << " rounds found an exhausted stripe" << std::endl;
+    throw std::runtime_error("stripe exhausted after a completed refresh");
+  }
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "scqueue/transfer_queue.hpp"
+
+using transfer_queue_t = scq::d::transfer_queue_t<int, 10, 3>;
+
+int main() {
+  const std::size_t thread_count = 8;
+  const std::size_t count = 16'384;
+
+  auto queue = std::make_unique<transfer_queue_t>();
+  std::vector<std::vector<int>> thread_elements(thread_count);
+  for (auto& elements : thread_elements) {
+    for (auto i = 0; i < count; ++i) {
+      elements.push_back(i);
+    }
+  }
+
+  std::atomic_bool start{ false };
+  std::atomic_uint64_t sum{ 0 };
+
+  std::vector<std::thread> threads{ };
+  // more consumers than reservations, so some consumers have to poll
+  for (auto thread = 0; thread < 2 * thread_count; ++thread) {
+    threads.emplace_back([&] {
+      std::uint64_t thread_sum = 0;
+      while (!start.load());
+
+      for (auto op = 0; op < count / 2; ++op) {
+        thread_sum += *queue->dequeue_wait();
+      }
+
+      sum.fetch_add(thread_sum);
+    });
+  }
+
+  for (auto thread = 0; thread < thread_count; ++thread) {
+    threads.emplace_back([&, thread] {
+      while (!start.load());
+
+      for (auto op = 0; op < count; ++op) {
+        while (!queue->try_enqueue(&thread_elements[thread][op]));
+        // leave consumers time to run out of elements and wait
+        if (op % 1024 == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  start.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  int* res;
+  if (queue->try_dequeue(res)) {
+    throw std::runtime_error("queue not empty after consuming all elements");
+  }
+
+  const auto expected = thread_count * (count * (count - 1) / 2);
+  if (sum.load() != expected) {
+    throw std::runtime_error("incorrect element sum");
+  }
+
+  std::cout << "test successful (sum = " << sum.load() << ")" << std::endl;
+  return 0;
+}